@@ -121,6 +121,8 @@ atomic_uint nb_output_dumped = 0;
 
 static BenchmarkTimeStamps current_time;
 AVIOContext *progress_avio = NULL;
+AVIOContext *stats_json_avio = NULL;
+AVIOContext *latency_trace_avio = NULL;
 
 InputFile   **input_files   = NULL;
 int        nb_input_files   = 0;
@@ -350,10 +352,20 @@ static void ffmpeg_cleanup(int ret)
     }
     av_freep(&vstats_filename);
     of_enc_stats_close();
+    latency_trace_close();
+
+    if (stats_json_avio) {
+        int err = avio_closep(&stats_json_avio);
+        if (err < 0)
+            av_log(NULL, AV_LOG_ERROR,
+                   "Error closing stats log, loss of information possible: %s\n",
+                   av_err2str(err));
+    }
 
     hw_device_free_all();
 
     av_freep(&filter_nbthreads);
+    av_freep(&filter_negotiation);
 
     av_freep(&input_files);
     av_freep(&output_files);
@@ -490,6 +502,30 @@ void update_benchmark(const char *fmt, ...)
     }
 }
 
+static void print_stats_json(Scheduler *sch, int is_last_report,
+                             int64_t timer_start, int64_t cur_time)
+{
+    AVBPrint buf;
+
+    if (!stats_json_avio)
+        return;
+
+    av_bprint_init(&buf, 0, AV_BPRINT_SIZE_UNLIMITED);
+
+    av_bprintf(&buf, "{\"time\":%.6f,\"last\":%d,\"nodes\":",
+               (cur_time - timer_start) / 1e6, is_last_report);
+    sch_stats_print(sch, &buf);
+    av_bprint_chars(&buf, '}', 1);
+    av_bprint_chars(&buf, '\n', 1);
+
+    if (av_bprint_is_complete(&buf)) {
+        avio_write(stats_json_avio, buf.str, buf.len);
+        avio_flush(stats_json_avio);
+    }
+
+    av_bprint_finalize(&buf, NULL);
+}
+
 static void print_report(int is_last_report, int64_t timer_start, int64_t cur_time, int64_t pts)
 {
     AVBPrint buf, buf_script;
@@ -939,6 +975,7 @@ static int transcode(Scheduler *sch)
 
         /* dump report by using the output first video and audio streams */
         print_report(0, timer_start, cur_time, transcode_ts);
+        print_stats_json(sch, 0, timer_start, cur_time);
     }
 
     ret = sch_stop(sch, &transcode_ts);
@@ -953,6 +990,7 @@ static int transcode(Scheduler *sch)
 
     /* dump report by using the first video and audio streams */
     print_report(1, timer_start, av_gettime_relative(), transcode_ts);
+    print_stats_json(sch, 1, timer_start, av_gettime_relative());
 
     return ret;
 }
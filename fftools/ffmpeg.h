@@ -648,12 +648,18 @@ extern int print_stats;
 extern int64_t stats_period;
 extern int stdin_interaction;
 extern AVIOContext *progress_avio;
+extern AVIOContext *stats_json_avio;
+extern AVIOContext *latency_trace_avio;
+extern int latency_trace_sample;
 extern float max_error_rate;
 
 extern char *filter_nbthreads;
 extern int filter_complex_nbthreads;
+extern int64_t filter_pool_size;
+extern char *filter_negotiation;
 extern int vstats_version;
 extern int auto_conversion_filters;
+extern int share_filter_prefix;
 
 extern const AVIOInterruptCB int_cb;
 
@@ -693,6 +699,19 @@ int init_simple_filtergraph(InputStream *ist, OutputStream *ost,
                             char *graph_desc,
                             Scheduler *sch, unsigned sch_idx_enc);
 int init_complex_filtergraph(FilterGraph *fg);
+/**
+ * Create the simple filtergraphs postponed by init_simple_filtergraph() when
+ * -share_filter_prefix is enabled. Output streams fed from the same input
+ * stream whose filter chains start with the same filters are merged into a
+ * single filtergraph, in which the common prefix is run once and its output
+ * split between the remaining per-stream chains.
+ */
+int init_shared_filtergraphs(void);
+/**
+ * Free the simple filtergraphs still postponed for prefix sharing, when
+ * option parsing fails before init_shared_filtergraphs() runs.
+ */
+void uninit_shared_filtergraphs(void);
 
 int copy_av_subtitle(AVSubtitle *dst, const AVSubtitle *src);
 int subtitle_wrap_frame(AVFrame *frame, AVSubtitle *subtitle, int copy);
@@ -783,6 +802,7 @@ int of_open(const OptionsContext *o, const char *filename, Scheduler *sch);
 void of_free(OutputFile **pof);
 
 void of_enc_stats_close(void);
+void latency_trace_close(void);
 
 int64_t of_filesize(OutputFile *of);
 
@@ -49,6 +49,9 @@ typedef struct FilterGraphPriv {
     char log_name[32];
 
     int is_simple;
+    // simple filtergraphs of several output streams merged together
+    // because they share a common filter chain prefix
+    int is_shared;
     // true when the filtergraph contains only meta filters
     // that do not modify the frame data
     int is_meta;
@@ -1039,9 +1042,27 @@ fail:
     return 0;
 }
 
-int init_simple_filtergraph(InputStream *ist, OutputStream *ost,
-                            char *graph_desc,
-                            Scheduler *sch, unsigned sched_idx_enc)
+/* Simple filtergraphs whose creation is postponed until all the output
+ * streams are known, so that common prefixes can be detected. */
+typedef struct SimpleFilterPending {
+    InputStream  *ist;
+    OutputStream *ost;
+    char         *graph_desc;
+    Scheduler    *sch;
+    unsigned      sched_idx_enc;
+
+    // graph_desc split into individual filters,
+    // NULL when it is not a single linear chain
+    char        **chain;
+    int        nb_chain;
+} SimpleFilterPending;
+
+static SimpleFilterPending **pending_simple;
+static int                nb_pending_simple;
+
+static int create_simple_filtergraph(InputStream *ist, OutputStream *ost,
+                                     char *graph_desc,
+                                     Scheduler *sch, unsigned sched_idx_enc)
 {
     FilterGraph *fg;
     FilterGraphPriv *fgp;
@@ -1080,6 +1101,295 @@ int init_simple_filtergraph(InputStream *ist, OutputStream *ost,
     return 0;
 }
 
+/**
+ * Split a filtergraph description into its individual filters.
+ *
+ * @return 1 if desc is a single linear chain of filters, stored in chain,
+ *         0 if it is anything else, a negative error code on failure
+ */
+static int split_filter_chain(const char *desc, char ***chain, int *nb_chain)
+{
+    const char *start = desc, *p;
+    int quoted = 0;
+
+    for (p = desc; ; p++) {
+        if (*p == '\\' && p[1]) {
+            p++;
+            continue;
+        }
+        if (*p == '\'')
+            quoted = !quoted;
+        if (quoted && *p)
+            continue;
+        if (*p == ';' || *p == '[')
+            return 0;
+
+        if (*p == ',' || !*p) {
+            const char *end = p;
+            char *filter;
+            int ret;
+
+            start += strspn(start, " \n\t\r");
+            while (end > start && strchr(" \n\t\r", end[-1]))
+                end--;
+            if (end == start)
+                return 0;
+
+            filter = av_strndup(start, end - start);
+            if (!filter)
+                return AVERROR(ENOMEM);
+
+            ret = GROW_ARRAY(*chain, *nb_chain);
+            if (ret < 0) {
+                av_freep(&filter);
+                return ret;
+            }
+            (*chain)[*nb_chain - 1] = filter;
+
+            if (!*p)
+                break;
+            start = p + 1;
+        }
+    }
+
+    return !quoted;
+}
+
+static void pending_simple_uninit(SimpleFilterPending *sfp)
+{
+    for (int i = 0; i < sfp->nb_chain; i++)
+        av_freep(&sfp->chain[i]);
+    av_freep(&sfp->chain);
+    sfp->nb_chain = 0;
+
+    av_freep(&sfp->graph_desc);
+    sfp->ost = NULL;
+}
+
+int init_simple_filtergraph(InputStream *ist, OutputStream *ost,
+                            char *graph_desc,
+                            Scheduler *sch, unsigned sched_idx_enc)
+{
+    SimpleFilterPending *sfp;
+    int ret;
+
+    if (!share_filter_prefix)
+        return create_simple_filtergraph(ist, ost, graph_desc, sch, sched_idx_enc);
+
+    sfp = allocate_array_elem(&pending_simple, sizeof(*sfp), &nb_pending_simple);
+    if (!sfp) {
+        av_freep(&graph_desc);
+        return AVERROR(ENOMEM);
+    }
+
+    sfp->ist           = ist;
+    sfp->ost           = ost;
+    sfp->graph_desc    = graph_desc;
+    sfp->sch           = sch;
+    sfp->sched_idx_enc = sched_idx_enc;
+
+    ret = split_filter_chain(graph_desc, &sfp->chain, &sfp->nb_chain);
+    if (ret < 0)
+        return ret;
+    if (!ret) {
+        for (int i = 0; i < sfp->nb_chain; i++)
+            av_freep(&sfp->chain[i]);
+        av_freep(&sfp->chain);
+        sfp->nb_chain = 0;
+    }
+
+    return 0;
+}
+
+static int dict_equal(const AVDictionary *a, const AVDictionary *b)
+{
+    const AVDictionaryEntry *e = NULL;
+
+    if (av_dict_count(a) != av_dict_count(b))
+        return 0;
+
+    while ((e = av_dict_iterate(a, e))) {
+        const AVDictionaryEntry *e1 = av_dict_get(b, e->key, NULL, 0);
+        if (!e1 || strcmp(e->value, e1->value))
+            return 0;
+    }
+
+    return 1;
+}
+
+static int pending_common_prefix(const SimpleFilterPending *a,
+                                 const SimpleFilterPending *b)
+{
+    int nb_common = 0;
+
+    if (a->ist != b->ist || a->ost->type != b->ost->type ||
+        !a->chain || !b->chain ||
+        !dict_equal(a->ost->sws_dict, b->ost->sws_dict) ||
+        !dict_equal(a->ost->swr_opts, b->ost->swr_opts))
+        return 0;
+
+    while (nb_common < FFMIN(a->nb_chain, b->nb_chain) &&
+           !strcmp(a->chain[nb_common], b->chain[nb_common]))
+        nb_common++;
+
+    return nb_common;
+}
+
+static int create_shared_filtergraph(SimpleFilterPending **group, int nb_group,
+                                     int nb_prefix)
+{
+    const SimpleFilterPending *first = group[0];
+    FilterGraph     *fg;
+    FilterGraphPriv *fgp;
+    AVBPrint bp;
+    char *graph_desc;
+    int ret;
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+
+    for (int i = 0; i < nb_prefix; i++)
+        av_bprintf(&bp, "%s%s", i ? "," : "", first->chain[i]);
+    av_bprintf(&bp, ",%s=%d", first->ost->type == AVMEDIA_TYPE_AUDIO ?
+                              "asplit" : "split", nb_group);
+    for (int i = 0; i < nb_group; i++)
+        av_bprintf(&bp, "[shared_%s%d]",
+                   group[i]->nb_chain > nb_prefix ? "in" : "out", i);
+
+    for (int i = 0; i < nb_group; i++) {
+        const SimpleFilterPending *sfp = group[i];
+
+        if (sfp->nb_chain == nb_prefix)
+            continue;
+
+        av_bprintf(&bp, ";[shared_in%d]", i);
+        for (int j = nb_prefix; j < sfp->nb_chain; j++)
+            av_bprintf(&bp, "%s%s", j > nb_prefix ? "," : "", sfp->chain[j]);
+        av_bprintf(&bp, "[shared_out%d]", i);
+    }
+
+    ret = av_bprint_finalize(&bp, &graph_desc);
+    if (ret < 0)
+        return ret;
+
+    ret = fg_create(&fg, graph_desc, first->sch);
+    if (ret < 0)
+        return ret;
+    fgp = fgp_from_fg(fg);
+
+    fgp->is_shared = 1;
+
+    av_log(fg, AV_LOG_VERBOSE, "Sharing the filter chain prefix of %d output "
+           "streams fed from input stream #%d:%d: %s\n", nb_group,
+           first->ist->file->index, first->ist->index, fgp->graph_desc);
+
+    av_assert0(fg->nb_inputs == 1 && fg->nb_outputs == nb_group);
+
+    ret = ifilter_bind_ist(fg->inputs[0], first->ist);
+    if (ret < 0)
+        return ret;
+
+    for (int i = 0; i < nb_group; i++) {
+        OutputFilter *ofilter = NULL;
+        char label[32];
+
+        snprintf(label, sizeof(label), "shared_out%d", i);
+        for (int j = 0; j < fg->nb_outputs; j++)
+            if (fg->outputs[j]->linklabel &&
+                !strcmp(fg->outputs[j]->linklabel, label))
+                ofilter = fg->outputs[j];
+        av_assert0(ofilter);
+
+        group[i]->ost->filter = ofilter;
+
+        ret = ofilter_bind_ost(ofilter, group[i]->ost, group[i]->sched_idx_enc);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+static int is_null_chain(char **chain, int nb_chain)
+{
+    for (int i = 0; i < nb_chain; i++)
+        if (strcmp(chain[i], "null") && strcmp(chain[i], "anull"))
+            return 0;
+    return 1;
+}
+
+int init_shared_filtergraphs(void)
+{
+    SimpleFilterPending **group = NULL;
+    int ret = 0;
+
+    if (!nb_pending_simple)
+        return 0;
+
+    group = av_calloc(nb_pending_simple, sizeof(*group));
+    if (!group) {
+        ret = AVERROR(ENOMEM);
+        goto finish;
+    }
+
+    for (int i = 0; i < nb_pending_simple; i++) {
+        SimpleFilterPending *sfp = pending_simple[i];
+        int nb_group = 1, nb_prefix = sfp->nb_chain;
+
+        if (!sfp->ost)
+            continue;
+
+        group[0] = sfp;
+        for (int j = i + 1; j < nb_pending_simple; j++) {
+            SimpleFilterPending *other = pending_simple[j];
+            int nb_common;
+
+            if (!other->ost)
+                continue;
+
+            nb_common = pending_common_prefix(sfp, other);
+            if (!nb_common)
+                continue;
+
+            group[nb_group++] = other;
+            nb_prefix         = FFMIN(nb_prefix, nb_common);
+        }
+
+        if (nb_group > 1 && !is_null_chain(sfp->chain, nb_prefix)) {
+            ret = create_shared_filtergraph(group, nb_group, nb_prefix);
+            if (ret < 0)
+                goto finish;
+
+            for (int j = 0; j < nb_group; j++)
+                pending_simple_uninit(group[j]);
+            continue;
+        }
+
+        // graph_desc is now owned by the filtergraph
+        ret = create_simple_filtergraph(sfp->ist, sfp->ost, sfp->graph_desc,
+                                        sfp->sch, sfp->sched_idx_enc);
+        sfp->graph_desc = NULL;
+        pending_simple_uninit(sfp);
+        if (ret < 0)
+            goto finish;
+    }
+
+finish:
+    uninit_shared_filtergraphs();
+    av_freep(&group);
+
+    return ret;
+}
+
+void uninit_shared_filtergraphs(void)
+{
+    for (int i = 0; i < nb_pending_simple; i++) {
+        pending_simple_uninit(pending_simple[i]);
+        av_freep(&pending_simple[i]);
+    }
+    av_freep(&pending_simple);
+    nb_pending_simple = 0;
+}
+
 static int init_input_filter(FilterGraph *fg, InputFilter *ifilter)
 {
     FilterGraphPriv *fgp = fgp_from_fg(fg);
@@ -1685,6 +1995,58 @@ static int graph_is_meta(AVFilterGraph *graph)
 
 static int sub2video_frame(InputFilter *ifilter, AVFrame *frame, int buffer);
 
+static int ofilter_parameters_from_sink(OutputFilter *ofilter)
+{
+    OutputFilterPriv *ofp = ofp_from_ofilter(ofilter);
+    AVFilterContext *sink = ofp->filter;
+
+    ofp->format = av_buffersink_get_format(sink);
+
+    ofp->width  = av_buffersink_get_w(sink);
+    ofp->height = av_buffersink_get_h(sink);
+
+    // If the timing parameters are not locked yet, get the tentative values
+    // here but don't lock them. They will only be used if no output frames
+    // are ever produced.
+    if (!ofp->tb_out_locked) {
+        AVRational fr = av_buffersink_get_frame_rate(sink);
+        if (ofp->fps.framerate.num <= 0 && ofp->fps.framerate.den <= 0 &&
+            fr.num > 0 && fr.den > 0)
+            ofp->fps.framerate = fr;
+        ofp->tb_out = av_buffersink_get_time_base(sink);
+    }
+    ofp->sample_aspect_ratio = av_buffersink_get_sample_aspect_ratio(sink);
+
+    ofp->sample_rate    = av_buffersink_get_sample_rate(sink);
+    av_channel_layout_uninit(&ofp->ch_layout);
+    return av_buffersink_get_ch_layout(sink, &ofp->ch_layout);
+}
+
+/**
+ * The shared prefix of a graph created by -share_filter_prefix runs for all
+ * its output streams, so give it as many threads as the most demanding one.
+ *
+ * @return the thread count, 0 for automatic
+ */
+static int shared_graph_threads(const FilterGraph *fg)
+{
+    int threads = 1;
+
+    for (int i = 0; i < fg->nb_outputs; i++) {
+        const AVDictionaryEntry *e;
+        int t = 0;
+
+        e = av_dict_get(fg->outputs[i]->ost->encoder_opts, "threads", NULL, 0);
+        if (e && strcmp(e->value, "auto"))
+            t = strtol(e->value, NULL, 10);
+        if (t <= 0)
+            return 0;
+        threads = FFMAX(threads, t);
+    }
+
+    return threads;
+}
+
 static int configure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
 {
     FilterGraphPriv *fgp = fgp_from_fg(fg);
@@ -1699,13 +2061,17 @@ static int configure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
     if (!fgt->graph)
         return AVERROR(ENOMEM);
 
-    if (simple) {
+    if (simple || fgp->is_shared) {
         OutputStream *ost = fg->outputs[0]->ost;
 
         if (filter_nbthreads) {
             ret = av_opt_set(fgt->graph, "threads", filter_nbthreads, 0);
             if (ret < 0)
                 goto fail;
+        } else if (fgp->is_shared) {
+            ret = av_opt_set_int(fgt->graph, "threads", shared_graph_threads(fg), 0);
+            if (ret < 0)
+                goto fail;
         } else {
             const AVDictionaryEntry *e = NULL;
             e = av_dict_get(ost->encoder_opts, "threads", NULL, 0);
@@ -1733,6 +2099,21 @@ static int configure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
         fgt->graph->nb_threads = filter_complex_nbthreads;
     }
 
+    if (filter_pool_size) {
+        ret = av_opt_set_int(fgt->graph, "frame_pool_size", filter_pool_size, 0);
+        if (ret < 0)
+            goto fail;
+    }
+
+    if (filter_negotiation) {
+        ret = av_opt_set(fgt->graph, "format_negotiation", filter_negotiation, 0);
+        if (ret < 0) {
+            av_log(fg, AV_LOG_ERROR, "Invalid format negotiation strategy: %s\n",
+                   filter_negotiation);
+            goto fail;
+        }
+    }
+
     hw_device = hw_device_for_filter();
 
     if ((ret = graph_parse(fgt->graph, graph_desc, &inputs, &outputs, hw_device)) < 0)
@@ -1765,30 +2146,7 @@ static int configure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt)
     /* limit the lists of allowed formats to the ones selected, to
      * make sure they stay the same if the filtergraph is reconfigured later */
     for (i = 0; i < fg->nb_outputs; i++) {
-        OutputFilter *ofilter = fg->outputs[i];
-        OutputFilterPriv *ofp = ofp_from_ofilter(ofilter);
-        AVFilterContext *sink = ofp->filter;
-
-        ofp->format = av_buffersink_get_format(sink);
-
-        ofp->width  = av_buffersink_get_w(sink);
-        ofp->height = av_buffersink_get_h(sink);
-
-        // If the timing parameters are not locked yet, get the tentative values
-        // here but don't lock them. They will only be used if no output frames
-        // are ever produced.
-        if (!ofp->tb_out_locked) {
-            AVRational fr = av_buffersink_get_frame_rate(sink);
-            if (ofp->fps.framerate.num <= 0 && ofp->fps.framerate.den <= 0 &&
-                fr.num > 0 && fr.den > 0)
-                ofp->fps.framerate = fr;
-            ofp->tb_out = av_buffersink_get_time_base(sink);
-        }
-        ofp->sample_aspect_ratio = av_buffersink_get_sample_aspect_ratio(sink);
-
-        ofp->sample_rate    = av_buffersink_get_sample_rate(sink);
-        av_channel_layout_uninit(&ofp->ch_layout);
-        ret = av_buffersink_get_ch_layout(sink, &ofp->ch_layout);
+        ret = ofilter_parameters_from_sink(fg->outputs[i]);
         if (ret < 0)
             goto fail;
     }
@@ -2605,13 +2963,51 @@ static const char *unknown_if_null(const char *str)
     return str ? str : "unknown";
 }
 
+/*
+ * Try to propagate a new input frame size through the existing graph,
+ * without recreating it. Returns AVERROR(ENOSYS) if some filter in the
+ * way does not support that, in which case the graph is left as it was.
+ */
+static int reconfigure_filtergraph(FilterGraph *fg, FilterGraphThread *fgt,
+                                   InputFilter *ifilter)
+{
+    InputFilterPriv       *ifp = ifp_from_ifilter(ifilter);
+    AVBufferSrcParameters *par;
+    int ret;
+
+    par = av_buffersrc_parameters_alloc();
+    if (!par)
+        return AVERROR(ENOMEM);
+
+    par->width               = ifp->width;
+    par->height              = ifp->height;
+    par->sample_aspect_ratio = ifp->sample_aspect_ratio;
+
+    ret = av_buffersrc_parameters_set(ifp->filter, par);
+    av_freep(&par);
+    if (ret < 0)
+        return ret;
+
+    ret = avfilter_graph_reconfigure(fgt->graph, ifp->filter);
+    if (ret < 0)
+        return ret;
+
+    for (int i = 0; i < fg->nb_outputs; i++) {
+        ret = ofilter_parameters_from_sink(fg->outputs[i]);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 static int send_frame(FilterGraph *fg, FilterGraphThread *fgt,
                       InputFilter *ifilter, AVFrame *frame)
 {
     InputFilterPriv *ifp = ifp_from_ifilter(ifilter);
     FrameData       *fd;
     AVFrameSideData *sd;
-    int need_reinit = 0, ret;
+    int need_reinit = 0, size_only = 0, ret;
 
     /* determine if the parameters for this input changed */
     switch (ifp->type) {
@@ -2628,6 +3024,11 @@ static int send_frame(FilterGraph *fg, FilterGraphThread *fgt,
             ifp->color_space != frame->colorspace ||
             ifp->color_range != frame->color_range)
             need_reinit |= VIDEO_CHANGED;
+        /* a change of the frame size alone can be handled without
+         * renegotiating formats, see reconfigure_filtergraph() */
+        size_only = ifp->format      == frame->format     &&
+                    ifp->color_space == frame->colorspace &&
+                    ifp->color_range == frame->color_range;
         break;
     }
 
@@ -2699,7 +3100,18 @@ static int send_frame(FilterGraph *fg, FilterGraphThread *fgt,
             av_log(fg, AV_LOG_INFO, "Reconfiguring filter graph%s%s\n", reason.len ? " because " : "", reason.str);
         }
 
-        ret = configure_filtergraph(fg, fgt);
+        ret = AVERROR(ENOSYS);
+        if (fgt->graph && need_reinit == VIDEO_CHANGED && size_only) {
+            ret = reconfigure_filtergraph(fg, fgt, ifilter);
+            if (ret >= 0)
+                av_log(fg, AV_LOG_VERBOSE, "Filter graph reconfigured in place\n");
+            else if (ret != AVERROR(ENOSYS))
+                av_log(fg, AV_LOG_VERBOSE, "Reconfiguring in place failed: %s\n",
+                       av_err2str(ret));
+        }
+
+        if (ret < 0)
+            ret = configure_filtergraph(fg, fgt);
         if (ret < 0) {
             av_log(fg, AV_LOG_ERROR, "Error reinitializing filters!\n");
             return ret;
@@ -26,10 +26,12 @@
 #include "sync_queue.h"
 
 #include "libavutil/avstring.h"
+#include "libavutil/bprint.h"
 #include "libavutil/fifo.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/log.h"
 #include "libavutil/mem.h"
+#include "libavutil/thread.h"
 #include "libavutil/time.h"
 #include "libavutil/timestamp.h"
 
@@ -61,19 +63,119 @@ static int64_t filesize(AVIOContext *pb)
     return ret;
 }
 
-static void mux_log_debug_ts(OutputStream *ost, const AVPacket *pkt)
+static const char *const latency_probe_desc[] = {
+    [LATENCY_PROBE_DEMUX]       = "demux",
+    [LATENCY_PROBE_DEC_PRE]     = "decode",
+    [LATENCY_PROBE_DEC_POST]    = "decode",
+    [LATENCY_PROBE_FILTER_PRE]  = "filter",
+    [LATENCY_PROBE_FILTER_POST] = "filter",
+    [LATENCY_PROBE_ENC_PRE]     = "encode",
+    [LATENCY_PROBE_ENC_POST]    = "encode",
+    [LATENCY_PROBE_NB]          = "mux",
+};
+
+// serializes writes to latency_trace_avio from multiple muxer threads
+static AVMutex latency_trace_lock = AV_MUTEX_INITIALIZER;
+static int     latency_trace_started;
+
+static void latency_trace_event(AVBPrint *bp, const OutputStream *ost,
+                                const char *name, char phase, int64_t ts,
+                                uint64_t frame_num)
+{
+    av_bprintf(bp, ",\n{\"name\":\"%s\",\"cat\":\"latency\",\"ph\":\"%c\","
+               "\"id\":\"%d:%d:%"PRIu64"\",\"ts\":%"PRId64",\"pid\":%d,\"tid\":%d}",
+               name, phase, ost->file->index, ost->index, frame_num, ts,
+               ost->file->index, ost->index);
+}
+
+/**
+ * Write the lifetime of a packet, as recorded by its latency probes, into the
+ * trace file as a set of nested async events: one spanning the whole time
+ * from the first probe until now, and one for each stage between two
+ * consecutive probes.
+ */
+static void mux_latency_trace(OutputStream *ost, const AVPacket *pkt,
+                              uint64_t frame_num)
+{
+    const FrameData *fd;
+    int64_t now, start = INT64_MIN;
+    AVBPrint bp;
+
+    if (!pkt->opaque_ref ||
+        (latency_trace_sample > 1 && frame_num % latency_trace_sample))
+        return;
+
+    fd  = (const FrameData*)pkt->opaque_ref->data;
+    now = av_gettime_relative();
+
+    av_bprint_init(&bp, 0, AV_BPRINT_SIZE_UNLIMITED);
+
+    for (unsigned i = 0; i < FF_ARRAY_ELEMS(fd->wallclock); i++) {
+        int64_t val = fd->wallclock[i];
+        char name[64];
+        unsigned next;
+
+        if (val == INT64_MIN)
+            continue;
+
+        if (start == INT64_MIN) {
+            start = val;
+            av_bprintf(&bp, ",\n{\"name\":\"packet\",\"cat\":\"latency\",\"ph\":\"b\","
+                       "\"id\":\"%d:%d:%"PRIu64"\",\"ts\":%"PRId64",\"pid\":%d,\"tid\":%d,"
+                       "\"args\":{\"stream\":\"%d:%d\",\"pts\":%"PRId64",\"size\":%d}}",
+                       ost->file->index, ost->index, frame_num, start,
+                       ost->file->index, ost->index,
+                       ost->file->index, ost->index,
+                       pkt->pts == AV_NOPTS_VALUE ? -1 : pkt->pts, pkt->size);
+        }
+
+        for (next = i + 1; next < FF_ARRAY_ELEMS(fd->wallclock); next++)
+            if (fd->wallclock[next] != INT64_MIN)
+                break;
+
+        if (!strcmp(latency_probe_desc[i], latency_probe_desc[next]))
+            snprintf(name, sizeof(name), "%s", latency_probe_desc[i]);
+        else
+            snprintf(name, sizeof(name), "%s-%s", latency_probe_desc[i],
+                     latency_probe_desc[next]);
+
+        latency_trace_event(&bp, ost, name, 'b', val, frame_num);
+        latency_trace_event(&bp, ost, name, 'e',
+                            next < FF_ARRAY_ELEMS(fd->wallclock) ?
+                            fd->wallclock[next] : now, frame_num);
+    }
+
+    if (start != INT64_MIN && av_bprint_is_complete(&bp)) {
+        latency_trace_event(&bp, ost, "packet", 'e', now, frame_num);
+
+        // every event is preceded by a separator, except the very first one
+        ff_mutex_lock(&latency_trace_lock);
+        avio_write(latency_trace_avio, bp.str + !latency_trace_started,
+                   bp.len - !latency_trace_started);
+        latency_trace_started = 1;
+        ff_mutex_unlock(&latency_trace_lock);
+    }
+
+    av_bprint_finalize(&bp, NULL);
+}
+
+void latency_trace_close(void)
 {
-    static const char *desc[] = {
-        [LATENCY_PROBE_DEMUX]       = "demux",
-        [LATENCY_PROBE_DEC_PRE]     = "decode",
-        [LATENCY_PROBE_DEC_POST]    = "decode",
-        [LATENCY_PROBE_FILTER_PRE]  = "filter",
-        [LATENCY_PROBE_FILTER_POST] = "filter",
-        [LATENCY_PROBE_ENC_PRE]     = "encode",
-        [LATENCY_PROBE_ENC_POST]    = "encode",
-        [LATENCY_PROBE_NB]          = "mux",
-    };
+    int ret;
 
+    if (!latency_trace_avio)
+        return;
+
+    avio_printf(latency_trace_avio, "\n]\n");
+    if ((ret = avio_closep(&latency_trace_avio)) < 0)
+        av_log(NULL, AV_LOG_ERROR,
+               "Error closing latency trace, loss of information possible: %s\n",
+               av_err2str(ret));
+}
+
+static void mux_log_debug_ts(OutputStream *ost, const AVPacket *pkt)
+{
+    const char *const *desc = latency_probe_desc;
     char latency[512];
 
     *latency = 0;
@@ -233,7 +335,12 @@ static int write_packet(Muxer *mux, OutputStream *ost, AVPacket *pkt)
     if (ms->stats.io)
         enc_stats_write(ost, &ms->stats, NULL, pkt, frame_num);
 
+    if (latency_trace_avio)
+        mux_latency_trace(ost, pkt, frame_num);
+
+    sch_blocking_begin(mux->sch);
     ret = av_interleaved_write_frame(s, pkt);
+    sch_blocking_end(mux->sch);
     if (ret < 0) {
         av_log(ost, AV_LOG_ERROR,
                "Error submitting a packet to the muxer: %s\n",
@@ -74,6 +74,7 @@ int copy_ts           = 0;
 int start_at_zero     = 0;
 int copy_tb           = -1;
 int debug_ts          = 0;
+int latency_trace_sample = 1;
 int exit_on_error     = 0;
 int abort_on_flags    = 0;
 int print_stats       = -1;
@@ -81,8 +82,11 @@ int stdin_interaction = 1;
 float max_error_rate  = 2.0/3;
 char *filter_nbthreads;
 int filter_complex_nbthreads = 0;
+int64_t filter_pool_size = 0;
+char *filter_negotiation;
 int vstats_version = 2;
 int auto_conversion_filters = 1;
+int share_filter_prefix = 0;
 int64_t stats_period = 500000;
 
 
@@ -318,6 +322,19 @@ static int apply_sync_offsets(void)
     return 0;
 }
 
+static int opt_sched_threads(void *optctx, const char *opt, const char *arg)
+{
+    Scheduler *sch = optctx;
+    double num;
+    int ret;
+
+    ret = parse_number(opt, arg, OPT_TYPE_INT, 0, INT_MAX, &num);
+    if (ret < 0)
+        return ret;
+
+    return sch_set_threads(sch, num);
+}
+
 static int opt_filter_threads(void *optctx, const char *opt, const char *arg)
 {
     av_free(filter_nbthreads);
@@ -1390,6 +1407,13 @@ int ffmpeg_parse_options(int argc, char **argv, Scheduler *sch)
         goto fail;
     }
 
+    /* create the simple filtergraphs postponed for prefix sharing */
+    ret = init_shared_filtergraphs();
+    if (ret < 0) {
+        errmsg = "initializing shared filters";
+        goto fail;
+    }
+
     correct_input_start_times();
 
     ret = apply_sync_offsets();
@@ -1401,6 +1425,7 @@ int ffmpeg_parse_options(int argc, char **argv, Scheduler *sch)
         goto fail;
 
 fail:
+    uninit_shared_filtergraphs();
     uninit_parse_context(&octx);
     if (ret < 0 && ret != AVERROR_EXIT) {
         av_log(NULL, AV_LOG_FATAL, "Error %s: %s\n",
@@ -1426,6 +1451,52 @@ static int opt_progress(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+static int opt_stats_json(void *optctx, const char *opt, const char *arg)
+{
+    Scheduler *sch = optctx;
+    AVIOContext *avio = NULL;
+    int ret;
+
+    if (!strcmp(arg, "-"))
+        arg = "pipe:";
+    ret = avio_open2(&avio, arg, AVIO_FLAG_WRITE, &int_cb, NULL);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Failed to open stats URL \"%s\": %s\n",
+               arg, av_err2str(ret));
+        return ret;
+    }
+
+    ret = sch_enable_stats(sch);
+    if (ret < 0) {
+        avio_closep(&avio);
+        return ret;
+    }
+
+    avio_closep(&stats_json_avio);
+    stats_json_avio = avio;
+    return 0;
+}
+
+static int opt_latency_trace(void *optctx, const char *opt, const char *arg)
+{
+    AVIOContext *avio = NULL;
+    int ret;
+
+    if (!strcmp(arg, "-"))
+        arg = "pipe:";
+    ret = avio_open2(&avio, arg, AVIO_FLAG_WRITE, &int_cb, NULL);
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_ERROR, "Failed to open latency trace URL \"%s\": %s\n",
+               arg, av_err2str(ret));
+        return ret;
+    }
+
+    latency_trace_close();
+    latency_trace_avio = avio;
+    avio_printf(latency_trace_avio, "[\n");
+    return 0;
+}
+
 int opt_timelimit(void *optctx, const char *opt, const char *arg)
 {
 #if HAVE_SETRLIMIT
@@ -1573,6 +1644,15 @@ const OptionDef options[] = {
     { "progress",               OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
         { .func_arg = opt_progress },
       "write program-readable progress information", "url" },
+    { "stats_json",             OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_stats_json },
+      "write per-node scheduler statistics as JSON lines", "url" },
+    { "latency_trace",          OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_latency_trace },
+      "write per-packet pipeline latency as a Chrome trace event file", "url" },
+    { "latency_trace_sample",   OPT_TYPE_INT, OPT_EXPERT,
+        { &latency_trace_sample },
+      "trace only every Nth packet of each output stream", "N" },
     { "stdin",                  OPT_TYPE_BOOL, OPT_EXPERT,
         { &stdin_interaction },
       "enable or disable interaction on standard input" },
@@ -1680,6 +1760,14 @@ const OptionDef options[] = {
     { "filter_complex_threads", OPT_TYPE_INT, OPT_EXPERT,
         { &filter_complex_nbthreads },
         "number of threads for -filter_complex" },
+    { "filter_pool_size",       OPT_TYPE_INT64, OPT_EXPERT,
+        { &filter_pool_size },
+        "share video buffers between all links of each filtergraph, "
+        "keeping at most this many bytes of idle buffers", "size" },
+    { "filter_negotiation",     OPT_TYPE_STRING, OPT_EXPERT,
+        { &filter_negotiation },
+        "strategy used to pick the pixel formats of the filtergraph links "
+        "(greedy or cost)", "strategy" },
     { "lavfi",               OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
         { .func_arg = opt_filter_complex },
         "create a complex filtergraph", "graph_description" },
@@ -1691,6 +1779,12 @@ const OptionDef options[] = {
     { "auto_conversion_filters", OPT_TYPE_BOOL, OPT_EXPERT,
         { &auto_conversion_filters },
         "enable automatic conversion filters globally" },
+    { "share_filter_prefix", OPT_TYPE_BOOL, OPT_EXPERT,
+        { &share_filter_prefix },
+        "run filter chain prefixes common to several outputs of the same input only once" },
+    { "sched_threads",       OPT_TYPE_FUNC, OPT_FUNC_ARG | OPT_EXPERT,
+        { .func_arg = opt_sched_threads },
+        "maximum number of concurrently running transcoding tasks (0 = unlimited)", "number" },
     { "stats",               OPT_TYPE_BOOL, 0,
         { &print_stats },
         "print progress report during encoding", },
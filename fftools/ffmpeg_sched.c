@@ -69,6 +69,14 @@ typedef struct SchTask {
 
     pthread_t           thread;
     int                 thread_running;
+
+    // statistics, updated by the task thread only; see sch_stats_print()
+    atomic_uint_least64_t nb_in;
+    atomic_uint_least64_t nb_out;
+    // time in microseconds spent blocked waiting for input/output,
+    // only measured when Scheduler.stats_enabled is set
+    atomic_int_least64_t  wait_in;
+    atomic_int_least64_t  wait_out;
 } SchTask;
 
 typedef struct SchDec {
@@ -295,6 +303,16 @@ struct Scheduler {
     pthread_mutex_t     schedule_lock;
 
     atomic_int_least64_t last_dts;
+
+    // maximum number of concurrently running tasks, 0 for no limit
+    unsigned            nb_run_slots;
+    atomic_uint         run_slots_free;
+    // number of tasks waiting on run_slot_cond, modified under run_slot_lock
+    atomic_uint         run_slot_waiters;
+    pthread_mutex_t     run_slot_lock;
+    pthread_cond_t      run_slot_cond;
+
+    int                 stats_enabled;
 };
 
 /**
@@ -355,6 +373,88 @@ static void waiter_uninit(SchWaiter *w)
     pthread_cond_destroy(&w->cond);
 }
 
+/**
+ * Run slots implement -sched_threads: a task holds a slot while executing its
+ * own code and gives it up for the duration of every call into the scheduler,
+ * where it may block on a queue or a waiter, and around blocking I/O and sleeps
+ * marked with sch_blocking_begin()/sch_blocking_end(). Blocked tasks therefore
+ * never hold a slot, so at most nb_run_slots tasks compete for CPU at any time.
+ *
+ * The free slots are counted atomically, so the lock is only taken when a task
+ * has to wait for a slot or one has to be woken up.
+ */
+static int run_slot_try_acquire(Scheduler *sch)
+{
+    unsigned nb_free = atomic_load(&sch->run_slots_free);
+
+    while (nb_free) {
+        if (atomic_compare_exchange_weak(&sch->run_slots_free, &nb_free, nb_free - 1))
+            return 1;
+    }
+    return 0;
+}
+
+static void run_slot_acquire(Scheduler *sch)
+{
+    if (!sch->nb_run_slots || run_slot_try_acquire(sch))
+        return;
+
+    pthread_mutex_lock(&sch->run_slot_lock);
+
+    // registered before retrying, so a concurrent release sees the waiter
+    atomic_fetch_add(&sch->run_slot_waiters, 1);
+    while (!run_slot_try_acquire(sch))
+        pthread_cond_wait(&sch->run_slot_cond, &sch->run_slot_lock);
+    atomic_fetch_sub(&sch->run_slot_waiters, 1);
+
+    pthread_mutex_unlock(&sch->run_slot_lock);
+}
+
+static void run_slot_release(Scheduler *sch)
+{
+    unsigned nb_free;
+
+    if (!sch->nb_run_slots)
+        return;
+
+    nb_free = atomic_fetch_add(&sch->run_slots_free, 1);
+    av_assert0(nb_free < sch->nb_run_slots);
+
+    if (atomic_load(&sch->run_slot_waiters)) {
+        pthread_mutex_lock(&sch->run_slot_lock);
+        pthread_cond_signal(&sch->run_slot_cond);
+        pthread_mutex_unlock(&sch->run_slot_lock);
+    }
+}
+
+void sch_blocking_begin(Scheduler *sch)
+{
+    run_slot_release(sch);
+}
+
+void sch_blocking_end(Scheduler *sch)
+{
+    run_slot_acquire(sch);
+}
+
+static int64_t wait_start(const Scheduler *sch)
+{
+    return sch->stats_enabled ? av_gettime_relative() : 0;
+}
+
+static void wait_end(const Scheduler *sch, atomic_int_least64_t *wait,
+                     int64_t start)
+{
+    if (sch->stats_enabled)
+        atomic_fetch_add_explicit(wait, av_gettime_relative() - start,
+                                  memory_order_relaxed);
+}
+
+static void count_item(atomic_uint_least64_t *counter)
+{
+    atomic_fetch_add_explicit(counter, 1, memory_order_relaxed);
+}
+
 static int queue_alloc(ThreadQueue **ptq, unsigned nb_streams, unsigned queue_size,
                        enum QueueType type)
 {
@@ -426,6 +526,11 @@ static void task_init(Scheduler *sch, SchTask *task, enum SchedulerNodeType type
 
     task->func      = func;
     task->func_arg  = func_arg;
+
+    atomic_init(&task->nb_in,    0);
+    atomic_init(&task->nb_out,   0);
+    atomic_init(&task->wait_in,  0);
+    atomic_init(&task->wait_out, 0);
 }
 
 static int64_t trailing_dts(const Scheduler *sch, int count_finished)
@@ -602,6 +707,9 @@ void sch_free(Scheduler **psch)
     pthread_mutex_destroy(&sch->mux_done_lock);
     pthread_cond_destroy(&sch->mux_done_cond);
 
+    pthread_mutex_destroy(&sch->run_slot_lock);
+    pthread_cond_destroy(&sch->run_slot_cond);
+
     av_freep(psch);
 }
 
@@ -638,6 +746,14 @@ Scheduler *sch_alloc(void)
     if (ret)
         goto fail;
 
+    ret = pthread_mutex_init(&sch->run_slot_lock, NULL);
+    if (ret)
+        goto fail;
+
+    ret = pthread_cond_init(&sch->run_slot_cond, NULL);
+    if (ret)
+        goto fail;
+
     return sch;
 fail:
     sch_free(&sch);
@@ -651,6 +767,28 @@ int sch_sdp_filename(Scheduler *sch, const char *sdp_filename)
     return sch->sdp_filename ? 0 : AVERROR(ENOMEM);
 }
 
+int sch_set_threads(Scheduler *sch, unsigned nb_threads)
+{
+    if (sch->transcode_started)
+        return AVERROR(EINVAL);
+
+    sch->nb_run_slots = nb_threads;
+    atomic_init(&sch->run_slots_free, nb_threads);
+    atomic_init(&sch->run_slot_waiters, 0);
+
+    return 0;
+}
+
+int sch_enable_stats(Scheduler *sch)
+{
+    if (sch->transcode_started)
+        return AVERROR(EINVAL);
+
+    sch->stats_enabled = 1;
+
+    return 0;
+}
+
 static const AVClass sch_mux_class = {
     .class_name                = "SchMux",
     .version                   = LIBAVUTIL_VERSION_INT,
@@ -1802,22 +1940,32 @@ int sch_demux_send(Scheduler *sch, unsigned demux_idx, AVPacket *pkt,
                    unsigned flags)
 {
     SchDemux *d;
-    int terminate;
+    int64_t start;
+    int ret;
 
     av_assert0(demux_idx < sch->nb_demux);
     d = &sch->demux[demux_idx];
 
-    terminate = waiter_wait(sch, &d->waiter);
-    if (terminate)
-        return AVERROR_EXIT;
+    run_slot_release(sch);
+    start = wait_start(sch);
 
+    if (waiter_wait(sch, &d->waiter))
+        ret = AVERROR_EXIT;
     // flush the downstreams after seek
-    if (pkt->stream_index == -1)
-        return demux_flush(sch, d, pkt);
+    else if (pkt->stream_index == -1)
+        ret = demux_flush(sch, d, pkt);
+    else {
+        av_assert0(pkt->stream_index < d->nb_streams);
+        ret = demux_send_for_stream(sch, d, &d->streams[pkt->stream_index],
+                                    pkt, flags);
+        if (ret >= 0)
+            count_item(&d->task.nb_out);
+    }
 
-    av_assert0(pkt->stream_index < d->nb_streams);
+    wait_end(sch, &d->task.wait_out, start);
+    run_slot_acquire(sch);
 
-    return demux_send_for_stream(sch, d, &d->streams[pkt->stream_index], pkt, flags);
+    return ret;
 }
 
 static int demux_done(Scheduler *sch, unsigned demux_idx)
@@ -1845,12 +1993,21 @@ static int demux_done(Scheduler *sch, unsigned demux_idx)
 int sch_mux_receive(Scheduler *sch, unsigned mux_idx, AVPacket *pkt)
 {
     SchMux *mux;
+    int64_t start;
     int ret, stream_idx;
 
     av_assert0(mux_idx < sch->nb_mux);
     mux = &sch->mux[mux_idx];
 
+    run_slot_release(sch);
+    start = wait_start(sch);
     ret = tq_receive(mux->queue, &stream_idx, pkt);
+    wait_end(sch, &mux->task.wait_in, start);
+    run_slot_acquire(sch);
+
+    if (ret >= 0)
+        count_item(&mux->task.nb_in);
+
     pkt->stream_index = stream_idx;
     return ret;
 }
@@ -1893,7 +2050,9 @@ int sch_mux_sub_heartbeat(Scheduler *sch, unsigned mux_idx, unsigned stream_idx,
         if (ret < 0)
             return ret;
 
+        run_slot_release(sch);
         tq_send(dst->queue, 0, mux->sub_heartbeat_pkt);
+        run_slot_acquire(sch);
     }
 
     return 0;
@@ -1929,17 +2088,23 @@ static int mux_done(Scheduler *sch, unsigned mux_idx)
 int sch_dec_receive(Scheduler *sch, unsigned dec_idx, AVPacket *pkt)
 {
     SchDec *dec;
+    int64_t start;
     int ret, dummy;
 
     av_assert0(dec_idx < sch->nb_dec);
     dec = &sch->dec[dec_idx];
 
+    run_slot_release(sch);
+    start = wait_start(sch);
+
     // the decoder should have given us post-flush end timestamp in pkt
     if (dec->expect_end_ts) {
         Timestamp ts = (Timestamp){ .ts = pkt->pts, .tb = pkt->time_base };
         ret = av_thread_message_queue_send(dec->queue_end_ts, &ts, 0);
-        if (ret < 0)
+        if (ret < 0) {
+            run_slot_acquire(sch);
             return ret;
+        }
 
         dec->expect_end_ts = 0;
     }
@@ -1947,6 +2112,12 @@ int sch_dec_receive(Scheduler *sch, unsigned dec_idx, AVPacket *pkt)
     ret = tq_receive(dec->queue, &dummy, pkt);
     av_assert0(dummy <= 0);
 
+    wait_end(sch, &dec->task.wait_in, start);
+    run_slot_acquire(sch);
+
+    if (ret >= 0)
+        count_item(&dec->task.nb_in);
+
     // got a flush packet, on the next call to this function the decoder
     // will give us post-flush end timestamp
     if (ret >= 0 && !pkt->data && !pkt->side_data_elems && dec->queue_end_ts)
@@ -2002,15 +2173,11 @@ finish:
     return AVERROR_EOF;
 }
 
-int sch_dec_send(Scheduler *sch, unsigned dec_idx, AVFrame *frame)
+static int dec_send(Scheduler *sch, SchDec *dec, AVFrame *frame)
 {
-    SchDec *dec;
     int ret = 0;
     unsigned nb_done = 0;
 
-    av_assert0(dec_idx < sch->nb_dec);
-    dec = &sch->dec[dec_idx];
-
     for (unsigned i = 0; i < dec->nb_dst; i++) {
         uint8_t *finished = &dec->dst_finished[i];
         AVFrame *to_send  = frame;
@@ -2044,6 +2211,27 @@ finish:
            (nb_done == dec->nb_dst) ? AVERROR_EOF : 0;
 }
 
+int sch_dec_send(Scheduler *sch, unsigned dec_idx, AVFrame *frame)
+{
+    SchDec *dec;
+    int64_t start;
+    int ret;
+
+    av_assert0(dec_idx < sch->nb_dec);
+    dec = &sch->dec[dec_idx];
+
+    run_slot_release(sch);
+    start = wait_start(sch);
+    ret = dec_send(sch, dec, frame);
+    wait_end(sch, &dec->task.wait_out, start);
+    run_slot_acquire(sch);
+
+    if (ret >= 0)
+        count_item(&dec->task.nb_out);
+
+    return ret;
+}
+
 static int dec_done(Scheduler *sch, unsigned dec_idx)
 {
     SchDec *dec = &sch->dec[dec_idx];
@@ -2068,20 +2256,29 @@ static int dec_done(Scheduler *sch, unsigned dec_idx)
 int sch_enc_receive(Scheduler *sch, unsigned enc_idx, AVFrame *frame)
 {
     SchEnc *enc;
+    int64_t start;
     int ret, dummy;
 
     av_assert0(enc_idx < sch->nb_enc);
     enc = &sch->enc[enc_idx];
 
+    run_slot_release(sch);
+    start = wait_start(sch);
     ret = tq_receive(enc->queue, &dummy, frame);
+    wait_end(sch, &enc->task.wait_in, start);
+    run_slot_acquire(sch);
     av_assert0(dummy <= 0);
 
+    if (ret >= 0)
+        count_item(&enc->task.nb_in);
+
     return ret;
 }
 
 int sch_enc_send(Scheduler *sch, unsigned enc_idx, AVPacket *pkt)
 {
     SchEnc *enc;
+    int64_t start;
     int ret;
 
     av_assert0(enc_idx < sch->nb_enc);
@@ -2090,9 +2287,15 @@ int sch_enc_send(Scheduler *sch, unsigned enc_idx, AVPacket *pkt)
     if (enc->out_finished)
         return pkt ? AVERROR_EOF : 0;
 
+    run_slot_release(sch);
+    start = wait_start(sch);
     ret = send_to_mux(sch, &sch->mux[enc->dst.idx], enc->dst.idx_stream, pkt);
+    wait_end(sch, &enc->task.wait_out, start);
+    run_slot_acquire(sch);
     if (ret < 0)
         enc->out_finished = 1;
+    else if (pkt)
+        count_item(&enc->task.nb_out);
 
     return ret;
 }
@@ -2106,14 +2309,9 @@ static int enc_done(Scheduler *sch, unsigned enc_idx)
     return send_to_mux(sch, &sch->mux[enc->dst.idx], enc->dst.idx_stream, NULL);
 }
 
-int sch_filter_receive(Scheduler *sch, unsigned fg_idx,
-                       unsigned *in_idx, AVFrame *frame)
+static int filter_receive(Scheduler *sch, SchFilterGraph *fg,
+                          unsigned *in_idx, AVFrame *frame)
 {
-    SchFilterGraph *fg;
-
-    av_assert0(fg_idx < sch->nb_filters);
-    fg = &sch->filters[fg_idx];
-
     av_assert0(*in_idx <= fg->nb_inputs);
 
     // update scheduling to account for desired input stream, if it changed
@@ -2150,6 +2348,28 @@ int sch_filter_receive(Scheduler *sch, unsigned fg_idx,
     }
 }
 
+int sch_filter_receive(Scheduler *sch, unsigned fg_idx,
+                       unsigned *in_idx, AVFrame *frame)
+{
+    SchFilterGraph *fg;
+    int64_t start;
+    int ret;
+
+    av_assert0(fg_idx < sch->nb_filters);
+    fg = &sch->filters[fg_idx];
+
+    run_slot_release(sch);
+    start = wait_start(sch);
+    ret = filter_receive(sch, fg, in_idx, frame);
+    wait_end(sch, &fg->task.wait_in, start);
+    run_slot_acquire(sch);
+
+    if (ret >= 0)
+        count_item(&fg->task.nb_in);
+
+    return ret;
+}
+
 void sch_filter_receive_finish(Scheduler *sch, unsigned fg_idx, unsigned in_idx)
 {
     SchFilterGraph *fg;
@@ -2174,12 +2394,24 @@ void sch_filter_receive_finish(Scheduler *sch, unsigned fg_idx, unsigned in_idx)
 int sch_filter_send(Scheduler *sch, unsigned fg_idx, unsigned out_idx, AVFrame *frame)
 {
     SchFilterGraph *fg;
+    int64_t start;
+    int ret;
 
     av_assert0(fg_idx < sch->nb_filters);
     fg = &sch->filters[fg_idx];
 
     av_assert0(out_idx < fg->nb_outputs);
-    return send_to_enc(sch, &sch->enc[fg->outputs[out_idx].dst.idx], frame);
+
+    run_slot_release(sch);
+    start = wait_start(sch);
+    ret = send_to_enc(sch, &sch->enc[fg->outputs[out_idx].dst.idx], frame);
+    wait_end(sch, &fg->task.wait_out, start);
+    run_slot_acquire(sch);
+
+    if (ret >= 0 && frame)
+        count_item(&fg->task.nb_out);
+
+    return ret;
 }
 
 static int filter_done(Scheduler *sch, unsigned fg_idx)
@@ -2218,6 +2450,69 @@ int sch_filter_command(Scheduler *sch, unsigned fg_idx, AVFrame *frame)
     return send_to_filter(sch, fg, fg->nb_inputs, frame);
 }
 
+static void stats_print_task(AVBPrint *bp, const SchTask *task, const char *type,
+                             ThreadQueue *queue, SchWaiter *waiter, int first)
+{
+    const AVClass *cls = *(const AVClass**)task->func_arg;
+    const char  *name = cls->item_name(task->func_arg);
+
+    av_bprintf(bp, "%s{\"type\":\"%s\",\"index\":%u,\"name\":\"",
+               first ? "" : ",", type, task->node.idx);
+    for (; *name; name++) {
+        if (*name == '"' || *name == '\\')
+            av_bprint_chars(bp, '\\', 1);
+        if ((unsigned char)*name >= 0x20)
+            av_bprint_chars(bp, *name, 1);
+    }
+    av_bprintf(bp, "\",\"in\":%"PRIu64",\"out\":%"PRIu64,
+               (uint64_t)atomic_load(&task->nb_in),
+               (uint64_t)atomic_load(&task->nb_out));
+    av_bprintf(bp, ",\"wait_in\":%.6f,\"wait_out\":%.6f",
+               atomic_load(&task->wait_in)  / 1e6,
+               atomic_load(&task->wait_out) / 1e6);
+
+    if (queue) {
+        size_t nb_items, queue_size;
+
+        tq_get_fill(queue, &nb_items, &queue_size);
+        av_bprintf(bp, ",\"queue\":%zu,\"queue_size\":%zu",
+                   nb_items, queue_size);
+    }
+    if (waiter)
+        av_bprintf(bp, ",\"choked\":%d", atomic_load(&waiter->choked));
+
+    av_bprint_chars(bp, '}', 1);
+}
+
+void sch_stats_print(Scheduler *sch, AVBPrint *bp)
+{
+    int first = 1;
+
+    av_bprint_chars(bp, '[', 1);
+
+    if (!sch->transcode_started)
+        goto finish;
+
+    for (unsigned i = 0; i < sch->nb_demux; i++, first = 0)
+        stats_print_task(bp, &sch->demux[i].task, "demux",
+                         NULL, &sch->demux[i].waiter, first);
+    for (unsigned i = 0; i < sch->nb_dec; i++, first = 0)
+        stats_print_task(bp, &sch->dec[i].task, "dec",
+                         sch->dec[i].queue, NULL, first);
+    for (unsigned i = 0; i < sch->nb_filters; i++, first = 0)
+        stats_print_task(bp, &sch->filters[i].task, "filter",
+                         sch->filters[i].queue, &sch->filters[i].waiter, first);
+    for (unsigned i = 0; i < sch->nb_enc; i++, first = 0)
+        stats_print_task(bp, &sch->enc[i].task, "enc",
+                         sch->enc[i].queue, NULL, first);
+    for (unsigned i = 0; i < sch->nb_mux; i++, first = 0)
+        stats_print_task(bp, &sch->mux[i].task, "mux",
+                         sch->mux[i].queue, NULL, first);
+
+finish:
+    av_bprint_chars(bp, ']', 1);
+}
+
 static void *task_wrapper(void *arg)
 {
     SchTask  *task = arg;
@@ -2225,7 +2520,9 @@ static void *task_wrapper(void *arg)
     int ret;
     int err = 0;
 
+    run_slot_acquire(sch);
     ret = (intptr_t)task->func(task->func_arg);
+    run_slot_release(sch);
     if (ret < 0)
         av_log(task->func_arg, AV_LOG_ERROR,
                "Task finished with error code: %d (%s)\n", ret, av_err2str(ret));
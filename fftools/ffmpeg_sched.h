@@ -27,6 +27,8 @@
 
 #include "ffmpeg_utils.h"
 
+#include "libavutil/bprint.h"
+
 /*
  * This file contains the API for the transcode scheduler.
  *
@@ -126,6 +128,54 @@ typedef void* (*SchThreadFunc)(void *arg);
 Scheduler *sch_alloc(void);
 void sch_free(Scheduler **sch);
 
+/**
+ * Limit the number of tasks that are allowed to execute concurrently.
+ *
+ * Every component still runs in its own thread, but at most nb_threads of
+ * them hold a run slot at any given time. A task yields its slot whenever it
+ * calls into the scheduler (i.e. on every packet/frame handoff), so tasks
+ * blocked on their inputs or outputs never occupy a slot.
+ *
+ * Must be called before sch_start().
+ *
+ * @param nb_threads maximum number of running tasks, 0 means no limit
+ */
+int sch_set_threads(Scheduler *sch, unsigned nb_threads);
+
+/**
+ * Give up the run slot of the calling task while it blocks outside of the
+ * scheduler, e.g. in blocking I/O or a sleep. Must be paired with
+ * sch_blocking_end() before the task calls into the scheduler again.
+ *
+ * Does nothing when the number of running tasks is not limited.
+ */
+void sch_blocking_begin(Scheduler *sch);
+
+/**
+ * Wait for a run slot after sch_blocking_begin().
+ */
+void sch_blocking_end(Scheduler *sch);
+
+/**
+ * Enable measuring the time each task spends blocked on its inputs and
+ * outputs. Packet/frame counts are always maintained.
+ *
+ * Must be called before sch_start().
+ */
+int sch_enable_stats(Scheduler *sch);
+
+/**
+ * Print a snapshot of per-node scheduler statistics into bp, as a JSON array
+ * with one object per demuxer, decoder, filtergraph, encoder and muxer. Each
+ * object contains the number of items (packets or frames) received and sent
+ * by the node, the time (in seconds) it spent blocked waiting for input and
+ * output, the fill level of its input queue and whether it is currently
+ * choked by the scheduler, where applicable.
+ *
+ * May be called from any thread after sch_start().
+ */
+void sch_stats_print(Scheduler *sch, AVBPrint *bp);
+
 int sch_start(Scheduler *sch);
 int sch_stop(Scheduler *sch, int64_t *finish_ts);
 
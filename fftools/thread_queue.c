@@ -252,3 +252,13 @@ void tq_receive_finish(ThreadQueue *tq, unsigned int stream_idx)
 
     pthread_mutex_unlock(&tq->lock);
 }
+
+void tq_get_fill(ThreadQueue *tq, size_t *nb_items, size_t *queue_size)
+{
+    pthread_mutex_lock(&tq->lock);
+
+    *nb_items   = av_fifo_can_read(tq->fifo);
+    *queue_size = *nb_items + av_fifo_can_write(tq->fifo);
+
+    pthread_mutex_unlock(&tq->lock);
+}
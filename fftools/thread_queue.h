@@ -78,4 +78,11 @@ int tq_receive(ThreadQueue *tq, int *stream_idx, void *data);
  */
 void tq_receive_finish(ThreadQueue *tq, unsigned int stream_idx);
 
+/**
+ * Get the number of items currently stored in the queue and its capacity.
+ * The result is only a snapshot and may be outdated by the time the function
+ * returns; it is meant for statistics.
+ */
+void tq_get_fill(ThreadQueue *tq, size_t *nb_items, size_t *queue_size);
+
 #endif // FFTOOLS_THREAD_QUEUE_H
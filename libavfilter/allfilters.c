@@ -399,6 +399,7 @@ extern const AVFilter ff_vf_perms;
 extern const AVFilter ff_vf_perspective;
 extern const AVFilter ff_vf_phase;
 extern const AVFilter ff_vf_photosensitivity;
+extern const AVFilter ff_vf_pipeline;
 extern const AVFilter ff_vf_pixdesctest;
 extern const AVFilter ff_vf_pixelize;
 extern const AVFilter ff_vf_pixscope;
@@ -434,6 +435,7 @@ extern const AVFilter ff_vf_scale;
 extern const AVFilter ff_vf_scale_amf;
 extern const AVFilter ff_vf_scale_amf_hq;
 extern const AVFilter ff_vf_scale_cuda;
+extern const AVFilter ff_vf_scale_ladder;
 extern const AVFilter ff_vf_scale_npp;
 extern const AVFilter ff_vf_scale_qsv;
 extern const AVFilter ff_vf_scale_vaapi;
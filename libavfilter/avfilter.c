@@ -28,11 +28,13 @@
 #include "libavutil/eval.h"
 #include "libavutil/frame.h"
 #include "libavutil/hwcontext.h"
+#include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/rational.h"
 #include "libavutil/samplefmt.h"
+#include "libavutil/time.h"
 
 #include "audio.h"
 #include "avfilter.h"
@@ -222,7 +224,36 @@ static void update_link_current_pts(FilterLinkInternal *li, int64_t pts)
 
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
-    filter->ready = FFMAX(filter->ready, priority);
+    if (priority <= filter->ready)
+        return;
+    filter->ready = priority;
+    if (filter->graph)
+        ff_filter_graph_update_ready(filter->graph, filter);
+}
+
+void ff_filter_set_ready_async(AVFilterGraph *graph, AVFilterContext *filter,
+                               unsigned priority)
+{
+    FFFilterGraph *graphi = fffiltergraph(graph);
+    FFFilterContext *ctxi = fffilterctx(filter);
+
+    ff_mutex_lock(&graphi->async_lock);
+    ctxi->async_ready = FFMAX(ctxi->async_ready, priority);
+    atomic_store_explicit(&graphi->async_pending, 1, memory_order_release);
+    ff_cond_signal(&graphi->async_cond);
+    ff_mutex_unlock(&graphi->async_lock);
+}
+
+void ff_filter_set_async_waiting(AVFilterContext *filter, int waiting)
+{
+    FFFilterContext *ctxi = fffilterctx(filter);
+
+    waiting = !!waiting;
+    if (ctxi->async_waiting == waiting)
+        return;
+    ctxi->async_waiting = waiting;
+    if (filter->graph)
+        fffiltergraph(filter->graph)->nb_async_waiting += waiting ? 1 : -1;
 }
 
 /**
@@ -632,6 +663,7 @@ static const AVClass *filter_child_class_iterate(void **iter)
 }
 
 #define OFFSET(x) offsetof(AVFilterContext, x)
+#define IOFFSET(x) offsetof(FFFilterContext, x)
 #define FLAGS AV_OPT_FLAG_FILTERING_PARAM
 #define TFLAGS AV_OPT_FLAG_FILTERING_PARAM|AV_OPT_FLAG_RUNTIME_PARAM
 static const AVOption avfilter_options[] = {
@@ -643,6 +675,10 @@ static const AVOption avfilter_options[] = {
         { .i64 = 0 }, 0, INT_MAX, FLAGS },
     { "extra_hw_frames", "Number of extra hardware frames to allocate for the user",
         OFFSET(extra_hw_frames), AV_OPT_TYPE_INT, { .i64 = -1 }, -1, INT_MAX, FLAGS },
+    { "activations", "Number of times the filter was activated",
+        IOFFSET(nb_activations), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, FLAGS|AV_OPT_FLAG_EXPORT|AV_OPT_FLAG_READONLY },
+    { "activate_time", "Time spent in the filter in microseconds, if the graph has filter_timing set",
+        IOFFSET(activate_time), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, FLAGS|AV_OPT_FLAG_EXPORT|AV_OPT_FLAG_READONLY },
     { NULL },
 };
 
@@ -703,7 +739,8 @@ AVFilterContext *ff_filter_alloc(const AVFilter *filter, const char *inst_name)
         av_opt_set_defaults(ret->priv);
     }
 
-    ctx->execute = default_execute;
+    ctx->execute     = default_execute;
+    ctx->ready_index = -1;
 
     ret->nb_inputs  = filter->nb_inputs;
     if (ret->nb_inputs ) {
@@ -1306,7 +1343,9 @@ static int ff_filter_activate_default(AVFilterContext *filter)
      link_set_out_status().
 
    Filters are activated according to the ready field, set using the
-   ff_filter_set_ready(). Eventually, a priority queue will be used.
+   ff_filter_set_ready(). The graph keeps the ready filters in a priority
+   queue, so finding the next filter to activate does not depend on the
+   number of filters in the graph.
    ff_filter_set_ready() is called whenever anything could cause progress to
    be possible. Marking a filter ready when it is not is not a problem,
    except for the small overhead it causes.
@@ -1370,14 +1409,23 @@ static int ff_filter_activate_default(AVFilterContext *filter)
 
 int ff_filter_activate(AVFilterContext *filter)
 {
+    FFFilterContext *ctxi = fffilterctx(filter);
+    int64_t start = 0;
     int ret;
 
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
     filter->ready = 0;
+    if (filter->graph)
+        ff_filter_graph_update_ready(filter->graph, filter);
+    if (filter->graph && fffiltergraph(filter->graph)->filter_timing)
+        start = av_gettime_relative();
     ret = filter->filter->activate ? filter->filter->activate(filter) :
           ff_filter_activate_default(filter);
+    if (start)
+        ctxi->activate_time += av_gettime_relative() - start;
+    ctxi->nb_activations++;
     if (ret == FFERROR_NOT_READY)
         ret = 0;
     return ret;
@@ -1482,14 +1530,130 @@ AVFrame *ff_inlink_peek_frame(AVFilterLink *link, size_t idx)
     return ff_framequeue_peek(&li->fifo, idx);
 }
 
+void ff_inlink_set_writable_planes(AVFilterLink *link, unsigned planes)
+{
+    ff_link_internal(link)->writable_planes = planes;
+}
+
+/**
+ * Make the planes of a video frame in the planes mask writable, copying
+ * only those whose buffers are shared.
+ *
+ * @return 1 if the frame was handled, 0 if a full copy must be done instead,
+ *         or a negative error code
+ */
+static int make_planes_writable(AVFilterLink *link, AVFrame **rframe,
+                                unsigned planes)
+{
+    AVFrame *frame = *rframe;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+    AVBufferRef *bufs[4];
+    AVFrame *tmp, *out;
+    unsigned copy = 0;
+    int nb_planes, nb_bufs = 0, ret;
+
+    if (!desc || desc->flags & (AV_PIX_FMT_FLAG_HWACCEL | AV_PIX_FMT_FLAG_PAL) ||
+        frame->format != link->format ||
+        frame->width  != link->w || frame->height != link->h)
+        return 0;
+
+    nb_planes = av_pix_fmt_count_planes(frame->format);
+    for (int p = 0; p < nb_planes; p++) {
+        AVBufferRef *buf = av_frame_get_plane_buffer(frame, p);
+        if (!buf)
+            return 0;
+        if (planes & (1 << p) && !av_buffer_is_writable(buf))
+            copy |= 1 << p;
+    }
+    if (!copy)
+        return 1;
+    if (copy == (1 << nb_planes) - 1)
+        return 0;
+
+    av_log(link->dst, AV_LOG_DEBUG, "Copying planes 0x%x in avfilter.\n", copy);
+
+    tmp = ff_get_video_buffer(link, link->w, link->h);
+    if (!tmp)
+        return AVERROR(ENOMEM);
+
+    out = av_frame_alloc();
+    if (!out) {
+        av_frame_free(&tmp);
+        return AVERROR(ENOMEM);
+    }
+    ret = av_frame_ref(out, frame);
+    if (ret < 0)
+        goto fail;
+
+    /* Point the copied planes to the new buffers, then make out reference
+     * exactly the buffers its planes live in. */
+    for (int p = 0; p < nb_planes; p++) {
+        AVBufferRef *buf;
+        int i;
+
+        if (copy & (1 << p)) {
+            int h = p == 1 || p == 2 ?
+                    AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h) :
+                    frame->height;
+
+            av_image_copy_plane(tmp->data[p], tmp->linesize[p],
+                                frame->data[p], frame->linesize[p],
+                                av_image_get_linesize(frame->format, frame->width, p),
+                                h);
+            out->data[p]     = tmp->data[p];
+            out->linesize[p] = tmp->linesize[p];
+            buf = av_frame_get_plane_buffer(tmp, p);
+        } else {
+            buf = av_frame_get_plane_buffer(frame, p);
+        }
+        if (!buf) {
+            ret = AVERROR_BUG;
+            goto fail;
+        }
+
+        for (i = 0; i < nb_bufs && bufs[i] != buf; i++)
+            ;
+        if (i == nb_bufs)
+            bufs[nb_bufs++] = buf;
+    }
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(out->buf); i++)
+        av_buffer_unref(&out->buf[i]);
+    for (int i = 0; i < nb_bufs; i++) {
+        out->buf[i] = av_buffer_ref(bufs[i]);
+        if (!out->buf[i]) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+    }
+
+    av_frame_free(&tmp);
+    av_frame_free(&frame);
+    *rframe = out;
+    return 1;
+
+fail:
+    av_frame_free(&tmp);
+    av_frame_free(&out);
+    return ret;
+}
+
 int ff_inlink_make_frame_writable(AVFilterLink *link, AVFrame **rframe)
 {
+    FilterLinkInternal * const li = ff_link_internal(link);
     AVFrame *frame = *rframe;
     AVFrame *out;
     int ret;
 
     if (av_frame_is_writable(frame))
         return 0;
+
+    if (link->type == AVMEDIA_TYPE_VIDEO && li->writable_planes) {
+        ret = make_planes_writable(link, rframe, li->writable_planes);
+        if (ret)
+            return FFMIN(ret, 0);
+    }
+
     av_log(link->dst, AV_LOG_DEBUG, "Copying data in avfilter.\n");
 
     switch (link->type) {
@@ -960,6 +960,29 @@ enum {
  */
 int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx);
 
+/**
+ * Reconfigure the part of an already configured graph that depends on a
+ * filter, without reinitializing any filter.
+ *
+ * The output links of filter, and those of all filters downstream of it, are
+ * configured again by running their config_props callbacks. This is meant to
+ * propagate a new video frame size set on a buffer source with
+ * av_buffersrc_parameters_set(). Formats are not negotiated again, so the
+ * pixel format, color space and color range must not change.
+ *
+ * It is only supported if all the affected filters support it with their
+ * current options and no frames are queued on the affected links; otherwise
+ * AVERROR(ENOSYS) is returned, the graph is left untouched, and it has to be
+ * rebuilt instead.
+ *
+ * @param graph  the filter graph
+ * @param filter the filter whose output properties changed
+ * @return >= 0 in case of success, AVERROR(ENOSYS) if the graph cannot be
+ *         reconfigured in place, another negative AVERROR code on failure,
+ *         after which the graph must be freed
+ */
+int avfilter_graph_reconfigure(AVFilterGraph *graph, AVFilterContext *filter);
+
 /**
  * Free a graph, destroy its links, and set *graph to NULL.
  * If *graph is NULL, do nothing.
@@ -25,8 +25,11 @@
 #ifndef AVFILTER_AVFILTER_INTERNAL_H
 #define AVFILTER_AVFILTER_INTERNAL_H
 
+#include <stdatomic.h>
 #include <stdint.h>
 
+#include "libavutil/thread.h"
+
 #include "avfilter.h"
 #include "framequeue.h"
 
@@ -35,6 +38,12 @@ typedef struct FilterLinkInternal {
 
     struct FFFramePool *frame_pool;
 
+    /**
+     * Planes modified in place by the destination filter, bit n for plane n,
+     * or 0 for all of them. See ff_inlink_set_writable_planes().
+     */
+    unsigned writable_planes;
+
     /**
      * Queue of frames waiting to be filtered.
      */
@@ -101,11 +110,71 @@ typedef struct FFFilterGraph {
     struct FilterLinkInternal **sink_links;
     int sink_links_count;
 
+    /**
+     * Max-heap of the filters with a non-zero ready value, ordered by
+     * decreasing ready and then by increasing position in
+     * AVFilterGraph.filters. Has room for all the filters in the graph.
+     */
+    struct FFFilterContext **ready_filters;
+    unsigned nb_ready_filters;
+
+    /**
+     * Wakeups posted from other threads by ff_filter_set_ready_async(),
+     * moved to the ready heap by the thread running the graph. async_lock
+     * protects FFFilterContext.async_ready, async_pending is set when any of
+     * them may be non-zero.
+     */
+    AVMutex    async_lock;
+    AVCond     async_cond;
+    atomic_int async_pending;
+    /**
+     * Number of filters waiting for ff_filter_set_ready_async(), see
+     * ff_filter_set_async_waiting().
+     */
+    unsigned nb_async_waiting;
+
     unsigned disable_auto_convert;
 
+    /**
+     * Strategy used to pick the pixel formats of the links, one of the
+     * FORMAT_NEGOTIATION_* values of avfiltergraph.c.
+     */
+    int format_negotiation;
+
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+
+    /**
+     * Video buffer pool shared by all the links of the graph, allocated
+     * when frame_pool_size is set.
+     */
+    struct FFGraphFramePool *frame_pool;
+    int64_t frame_pool_size;
+
+    /**
+     * Statistics of frame_pool, exported as read-only options. They are
+     * copied from the pool under its lock by the thread running the graph,
+     * never from the buffer allocation path, which also runs on the slice
+     * threads.
+     */
+    int64_t frame_pool_hits;
+    int64_t frame_pool_misses;
+    int64_t frame_pool_evictions;
+
+    /**
+     * Number of video buffers allocated for the links of the graph, by
+     * frame_pool or by the per-link pools, exported as a read-only option.
+     * The per-link pools count into link_pool_allocs from any thread.
+     */
+    int64_t frame_allocations;
+    atomic_uint_least64_t link_pool_allocs;
+
+    /**
+     * If set, the time spent in the activate callback of each filter is
+     * accumulated in FFFilterContext.activate_time.
+     */
+    int filter_timing;
 } FFFilterGraph;
 
 static inline FFFilterGraph *fffiltergraph(AVFilterGraph *graph)
@@ -119,6 +188,12 @@ static inline FFFilterGraph *fffiltergraph(AVFilterGraph *graph)
 void ff_avfilter_graph_update_heap(AVFilterGraph *graph,
                                    struct FilterLinkInternal *li);
 
+/**
+ * Update the position of a filter in the ready heap after its ready
+ * value changed.
+ */
+void ff_filter_graph_update_ready(AVFilterGraph *graph, AVFilterContext *filter);
+
 /**
  * Allocate a new filter context and return it.
  *
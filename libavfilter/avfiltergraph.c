@@ -36,11 +36,20 @@
 #include "avfilter.h"
 #include "avfilter_internal.h"
 #include "buffersink.h"
+#include "filters.h"
 #include "formats.h"
+#include "framepool.h"
 #include "framequeue.h"
 #include "internal.h"
 
 #define OFFSET(x) offsetof(AVFilterGraph, x)
+#define IOFFSET(x) offsetof(FFFilterGraph, x)
+
+enum {
+    FORMAT_NEGOTIATION_GREEDY,
+    FORMAT_NEGOTIATION_COST,
+};
+
 #define F AV_OPT_FLAG_FILTERING_PARAM
 #define V AV_OPT_FLAG_VIDEO_PARAM
 #define A AV_OPT_FLAG_AUDIO_PARAM
@@ -55,6 +64,25 @@ static const AVOption filtergraph_options[] = {
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|V },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|A },
+    { "format_negotiation", "Strategy used to pick the pixel formats of the links",
+        IOFFSET(format_negotiation), AV_OPT_TYPE_INT, { .i64 = FORMAT_NEGOTIATION_GREEDY },
+        FORMAT_NEGOTIATION_GREEDY, FORMAT_NEGOTIATION_COST, F|V, .unit = "format_negotiation" },
+        { "greedy", "pick the formats link by link", 0, AV_OPT_TYPE_CONST,
+            { .i64 = FORMAT_NEGOTIATION_GREEDY }, .flags = F|V, .unit = "format_negotiation" },
+        { "cost", "minimize the total cost of the format conversions in the graph", 0, AV_OPT_TYPE_CONST,
+            { .i64 = FORMAT_NEGOTIATION_COST }, .flags = F|V, .unit = "format_negotiation" },
+    { "frame_pool_size", "Maximum size in bytes of the idle video buffers shared by all links, 0 to use per-link pools",
+        IOFFSET(frame_pool_size), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, F|V },
+    { "frame_pool_hits", "Number of video buffers reused from the shared pool",
+        IOFFSET(frame_pool_hits), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, F|V|AV_OPT_FLAG_EXPORT|AV_OPT_FLAG_READONLY },
+    { "frame_pool_misses", "Number of video buffers allocated by the shared pool",
+        IOFFSET(frame_pool_misses), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, F|V|AV_OPT_FLAG_EXPORT|AV_OPT_FLAG_READONLY },
+    { "frame_pool_evictions", "Number of idle video buffers freed to honor frame_pool_size",
+        IOFFSET(frame_pool_evictions), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, F|V|AV_OPT_FLAG_EXPORT|AV_OPT_FLAG_READONLY },
+    { "frame_allocations", "Number of video buffers allocated for the links, with or without the shared pool",
+        IOFFSET(frame_allocations), AV_OPT_TYPE_INT64, { .i64 = 0 }, 0, INT64_MAX, F|V|AV_OPT_FLAG_EXPORT|AV_OPT_FLAG_READONLY },
+    { "filter_timing", "Measure the time spent in each filter",
+        IOFFSET(filter_timing), AV_OPT_TYPE_BOOL, { .i64 = 0 }, 0, 1, F|V|A },
     { NULL },
 };
 
@@ -87,10 +115,21 @@ AVFilterGraph *avfilter_graph_alloc(void)
     if (!graph)
         return NULL;
 
+    if (ff_mutex_init(&graph->async_lock, NULL)) {
+        av_free(graph);
+        return NULL;
+    }
+    if (ff_cond_init(&graph->async_cond, NULL)) {
+        ff_mutex_destroy(&graph->async_lock);
+        av_free(graph);
+        return NULL;
+    }
+
     ret = &graph->p;
     ret->av_class = &filtergraph_class;
     av_opt_set_defaults(ret);
     ff_framequeue_global_init(&graph->frame_queues);
+    atomic_init(&graph->link_pool_allocs, 0);
 
     return ret;
 }
@@ -100,9 +139,19 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
     int i, j;
     for (i = 0; i < graph->nb_filters; i++) {
         if (graph->filters[i] == filter) {
+            if (filter->ready) {
+                filter->ready = 0;
+                ff_filter_graph_update_ready(graph, filter);
+            }
+            ff_filter_set_async_waiting(filter, 0);
             FFSWAP(AVFilterContext*, graph->filters[i],
                    graph->filters[graph->nb_filters - 1]);
             graph->nb_filters--;
+            if (i < graph->nb_filters) {
+                fffilterctx(graph->filters[i])->graph_index = i;
+                if (graph->filters[i]->ready)
+                    ff_filter_graph_update_ready(graph, graph->filters[i]);
+            }
             filter->graph = NULL;
             for (j = 0; j<filter->nb_outputs; j++)
                 if (filter->outputs[j])
@@ -126,7 +175,20 @@ void avfilter_graph_free(AVFilterGraph **graphp)
 
     ff_graph_thread_free(graphi);
 
+    if (graphi->frame_pool) {
+        FFGraphFramePoolStats stats;
+
+        ff_graph_frame_pool_get_stats(graphi->frame_pool, &stats);
+        av_log(graph, AV_LOG_VERBOSE, "Frame pool: %"PRId64" hits, %"PRId64" misses, "
+               "%"PRId64" evictions\n", stats.hits, stats.misses, stats.evictions);
+        ff_graph_frame_pool_uninit(&graphi->frame_pool);
+    }
+
     av_freep(&graphi->sink_links);
+    av_freep(&graphi->ready_filters);
+
+    ff_cond_destroy(&graphi->async_cond);
+    ff_mutex_destroy(&graphi->async_lock);
 
     av_opt_free(graph);
 
@@ -166,6 +228,7 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
                                              const char *name)
 {
     AVFilterContext **filters, *s;
+    FFFilterContext **ready;
     FFFilterGraph *graphi = fffiltergraph(graph);
 
     if (graph->thread_type && !graphi->thread_execute) {
@@ -185,10 +248,17 @@ AVFilterContext *avfilter_graph_alloc_filter(AVFilterGraph *graph,
         return NULL;
     graph->filters = filters;
 
+    ready = av_realloc_array(graphi->ready_filters, graph->nb_filters + 1,
+                             sizeof(*ready));
+    if (!ready)
+        return NULL;
+    graphi->ready_filters = ready;
+
     s = ff_filter_alloc(filter, name);
     if (!s)
         return NULL;
 
+    fffilterctx(s)->graph_index = graph->nb_filters;
     graph->filters[graph->nb_filters++] = s;
 
     s->graph = graph;
@@ -1245,6 +1315,244 @@ static int pick_formats(AVFilterGraph *graph)
     return 0;
 }
 
+/* Weights of the format conversion cost model. */
+#define CONVERSION_COST_BASE  64  ///< any conversion, whatever the formats
+#define CONVERSION_COST_LOSS 256  ///< each kind of precision loss
+
+/**
+ * Estimate the cost of converting video frames from src to dst: a fixed
+ * part, the memory traffic in bits per pixel read and written, and a
+ * penalty for each kind of precision loss.
+ */
+static int conversion_cost(enum AVPixelFormat src, enum AVPixelFormat dst)
+{
+    const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(src);
+    const AVPixFmtDescriptor *dst_desc = av_pix_fmt_desc_get(dst);
+    int loss;
+
+    if (src == dst)
+        return 0;
+    if (!src_desc || !dst_desc)
+        return INT_MAX / 4;
+
+    loss  = av_get_pix_fmt_loss(dst, src, !!(src_desc->flags & AV_PIX_FMT_FLAG_ALPHA));
+    loss &= ~(FF_LOSS_EXCESS_RESOLUTION | FF_LOSS_EXCESS_DEPTH);
+
+    return CONVERSION_COST_BASE +
+           av_get_padded_bits_per_pixel(src_desc) +
+           av_get_padded_bits_per_pixel(dst_desc) +
+           av_popcount(loss) * CONVERSION_COST_LOSS;
+}
+
+static int is_video_converter(AVFilterContext *filter)
+{
+    return filter->nb_inputs == 1 && filter->nb_outputs == 1 &&
+           filter->inputs[0]->type == AVMEDIA_TYPE_VIDEO &&
+           !strcmp(filter->filter->name,
+                   ff_filter_get_negotiation(filter->inputs[0])->conversion_filter);
+}
+
+/**
+ * Set of links which must share the same pixel format, i.e. which share
+ * the same merged formats list.
+ */
+typedef struct FormatGroup {
+    AVFilterFormats *formats;
+    int choice;                 ///< index of the chosen format, or -1
+} FormatGroup;
+
+typedef struct FormatConversion {
+    int src, dst;               ///< indices of the input and output groups
+} FormatConversion;
+
+static int format_group_index(FormatGroup *groups, int *nb_groups,
+                              AVFilterFormats *formats)
+{
+    for (int i = 0; i < *nb_groups; i++)
+        if (groups[i].formats == formats)
+            return i;
+
+    groups[*nb_groups].formats = formats;
+    groups[*nb_groups].choice  = formats->nb_formats == 1 ? 0 : -1;
+    return (*nb_groups)++;
+}
+
+/**
+ * Cost of the conversions between group g and its neighbours if g uses fmt.
+ * Undecided neighbours count with their cheapest format.
+ */
+static int64_t format_group_cost(const FormatGroup *groups,
+                                 const FormatConversion *convs, int nb_convs,
+                                 int g, enum AVPixelFormat fmt)
+{
+    int64_t cost = 0;
+
+    for (int i = 0; i < nb_convs; i++) {
+        int is_src = convs[i].src == g;
+        const FormatGroup *other;
+        int best = INT_MAX;
+
+        if (!is_src && convs[i].dst != g)
+            continue;
+        other = &groups[is_src ? convs[i].dst : convs[i].src];
+
+        for (int j = 0; j < other->formats->nb_formats; j++) {
+            enum AVPixelFormat ofmt;
+            int c;
+
+            if (other->choice >= 0 && j != other->choice)
+                continue;
+            ofmt = other->formats->formats[j];
+            c = is_src ? conversion_cost(fmt, ofmt) : conversion_cost(ofmt, fmt);
+            best = FFMIN(best, c);
+        }
+        cost += best;
+    }
+
+    return cost;
+}
+
+/**
+ * Choose the pixel formats of the links adjacent to the format converters
+ * so as to minimize the total conversion cost over the whole graph.
+ *
+ * The links are partitioned into groups sharing a formats list, and the
+ * converters are the edges between the groups. Each group is assigned the
+ * format minimizing the cost of its conversions given its neighbours, the
+ * most constrained groups first, until no assignment changes. Groups for
+ * which all the candidates cost the same are left to pick_formats().
+ */
+static int negotiate_formats_by_cost(AVFilterGraph *graph)
+{
+    FormatGroup *groups;
+    FormatConversion *convs;
+    int *order;
+    int nb_groups = 0, nb_convs = 0, changed = 1, ret = 0;
+
+    groups = av_calloc(2 * graph->nb_filters, sizeof(*groups));
+    convs  = av_calloc(graph->nb_filters, sizeof(*convs));
+    order  = av_calloc(2 * graph->nb_filters, sizeof(*order));
+    if (!groups || !convs || !order) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    for (int i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        AVFilterFormats *in, *out;
+
+        if (!is_video_converter(f))
+            continue;
+        in  = f->inputs[0]->incfg.formats;
+        out = f->outputs[0]->incfg.formats;
+        if (!in || !out || in == out)
+            continue;
+
+        convs[nb_convs].src = format_group_index(groups, &nb_groups, in);
+        convs[nb_convs].dst = format_group_index(groups, &nb_groups, out);
+        nb_convs++;
+    }
+
+    /* hardware formats are never converted by the software converters */
+    for (int i = 0; i < nb_groups; i++)
+        for (int j = 0; j < groups[i].formats->nb_formats; j++) {
+            const AVPixFmtDescriptor *desc =
+                av_pix_fmt_desc_get(groups[i].formats->formats[j]);
+            if (!desc || desc->flags & AV_PIX_FMT_FLAG_HWACCEL)
+                groups[i].choice = -2;
+        }
+
+    /* most constrained groups first */
+    for (int i = 0; i < nb_groups; i++) {
+        int j = i;
+        for (; j > 0 && groups[order[j - 1]].formats->nb_formats >
+                        groups[i].formats->nb_formats; j--)
+            order[j] = order[j - 1];
+        order[j] = i;
+    }
+
+    for (int iter = 0; changed && iter <= nb_groups; iter++) {
+        changed = 0;
+
+        for (int k = 0; k < nb_groups; k++) {
+            FormatGroup *g = &groups[order[k]];
+            int64_t min_cost = INT64_MAX, max_cost = INT64_MIN;
+            int best = -1;
+
+            if (g->choice == -2 || g->formats->nb_formats == 1)
+                continue;
+
+            for (int j = 0; j < g->formats->nb_formats; j++) {
+                int64_t cost = format_group_cost(groups, convs, nb_convs, order[k],
+                                                 g->formats->formats[j]);
+                if (cost < min_cost) {
+                    min_cost = cost;
+                    best     = j;
+                }
+                max_cost = FFMAX(max_cost, cost);
+            }
+
+            if (min_cost == max_cost)
+                best = -1;
+            if (best != g->choice) {
+                g->choice = best;
+                changed   = 1;
+            }
+        }
+    }
+
+    for (int i = 0; i < nb_groups; i++) {
+        AVFilterFormats *formats = groups[i].formats;
+
+        if (groups[i].choice < 0 || formats->nb_formats == 1)
+            continue;
+        av_log(graph, AV_LOG_DEBUG, "cost model picked %s out of %d formats\n",
+               av_get_pix_fmt_name(formats->formats[groups[i].choice]),
+               formats->nb_formats);
+        formats->formats[0]  = formats->formats[groups[i].choice];
+        formats->nb_formats = 1;
+    }
+
+end:
+    av_freep(&groups);
+    av_freep(&convs);
+    av_freep(&order);
+    return ret;
+}
+
+/**
+ * Log the format conversions done by the converters of the graph and
+ * their estimated cost.
+ */
+static void dump_format_plan(AVFilterGraph *graph, int level)
+{
+    int64_t total = 0;
+    int nb_conversions = 0;
+
+    if (av_log_get_level() < level)
+        return;
+
+    for (int i = 0; i < graph->nb_filters; i++) {
+        AVFilterContext *f = graph->filters[i];
+        enum AVPixelFormat src, dst;
+        int cost;
+
+        if (!is_video_converter(f))
+            continue;
+
+        src  = f->inputs[0]->format;
+        dst  = f->outputs[0]->format;
+        cost = conversion_cost(src, dst);
+        av_log(graph, level, "  %s: %s -> %s, cost %d\n", f->name,
+               av_get_pix_fmt_name(src), av_get_pix_fmt_name(dst), cost);
+        nb_conversions += src != dst;
+        total          += cost;
+    }
+
+    av_log(graph, level, "Format plan: %d conversions, total cost %"PRId64"\n",
+           nb_conversions, total);
+}
+
 /**
  * Configure the formats of all the links in the graph.
  */
@@ -1274,9 +1582,17 @@ static int graph_config_formats(AVFilterGraph *graph, void *log_ctx)
     swap_samplerates(graph);
     swap_channel_layouts(graph);
 
+    if (fffiltergraph(graph)->format_negotiation == FORMAT_NEGOTIATION_COST &&
+        (ret = negotiate_formats_by_cost(graph)) < 0)
+        return ret;
+
     if ((ret = pick_formats(graph)) < 0)
         return ret;
 
+    dump_format_plan(graph,
+                     fffiltergraph(graph)->format_negotiation == FORMAT_NEGOTIATION_COST ?
+                     AV_LOG_VERBOSE : AV_LOG_DEBUG);
+
     return 0;
 }
 
@@ -1322,6 +1638,20 @@ static int graph_config_pointers(AVFilterGraph *graph, void *log_ctx)
     return 0;
 }
 
+static int graph_config_frame_pool(AVFilterGraph *graph)
+{
+    FFFilterGraph *graphi = fffiltergraph(graph);
+
+    if (!graphi->frame_pool_size || graphi->frame_pool)
+        return 0;
+
+    graphi->frame_pool = ff_graph_frame_pool_alloc(graphi->frame_pool_size);
+    if (!graphi->frame_pool)
+        return AVERROR(ENOMEM);
+
+    return 0;
+}
+
 int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
 {
     int ret;
@@ -1330,6 +1660,8 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
         return ret;
     if ((ret = graph_config_formats(graphctx, log_ctx)))
         return ret;
+    if ((ret = graph_config_frame_pool(graphctx)))
+        return ret;
     if ((ret = graph_config_links(graphctx, log_ctx)))
         return ret;
     if ((ret = graph_check_links(graphctx, log_ctx)))
@@ -1340,6 +1672,85 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
     return 0;
 }
 
+static int reconfigure_check_link(AVFilterLink *link)
+{
+    FilterLinkInternal *li = ff_link_internal(link);
+
+    if (link->type != AVMEDIA_TYPE_VIDEO || link->hw_frames_ctx) {
+        av_log(link->dst, AV_LOG_VERBOSE, "Cannot reconfigure %s link from %s\n",
+               av_get_media_type_string(link->type), link->src->name);
+        return AVERROR(ENOSYS);
+    }
+    if (ff_framequeue_queued_frames(&li->fifo) || li->status_in || li->status_out) {
+        av_log(link->dst, AV_LOG_VERBOSE, "Cannot reconfigure busy link from %s\n",
+               link->src->name);
+        return AVERROR(ENOSYS);
+    }
+    return 0;
+}
+
+int avfilter_graph_reconfigure(AVFilterGraph *graph, AVFilterContext *filter)
+{
+    AVFilterContext **filters;
+    unsigned nb_filters = 0;
+    int ret = 0;
+
+    filters = av_malloc_array(graph->nb_filters, sizeof(*filters));
+    if (!filters)
+        return AVERROR(ENOMEM);
+
+    /* collect everything downstream of filter, and check that all of it
+     * can be reconfigured before touching anything */
+    filters[nb_filters++] = filter;
+    for (unsigned i = 0; i < nb_filters; i++) {
+        AVFilterContext *f = filters[i];
+
+        if (!(f->filter->flags_internal & FF_FILTER_FLAG_RECONFIGURABLE) ||
+            fffilterctx(f)->reconfigure_disabled) {
+            av_log(f, AV_LOG_VERBOSE, "Filter '%s' does not support reconfiguration\n",
+                   f->filter->name);
+            ret = AVERROR(ENOSYS);
+            goto end;
+        }
+
+        for (unsigned j = 0; j < f->nb_outputs; j++) {
+            AVFilterContext *dst = f->outputs[j]->dst;
+            unsigned k;
+
+            if ((ret = reconfigure_check_link(f->outputs[j])) < 0)
+                goto end;
+
+            for (k = 0; k < nb_filters && filters[k] != dst; k++);
+            if (k == nb_filters)
+                filters[nb_filters++] = dst;
+        }
+    }
+
+    /* the properties config_props may leave unset are inherited from the
+     * input in avfilter_config_links(), so reset them along with the state */
+    for (unsigned i = 0; i < nb_filters; i++) {
+        for (unsigned j = 0; j < filters[i]->nb_outputs; j++) {
+            AVFilterLink *link = filters[i]->outputs[j];
+
+            ff_link_internal(link)->init_state = AVLINK_UNINIT;
+            link->w = link->h = 0;
+            link->sample_aspect_ratio = (AVRational){ 0, 0 };
+        }
+    }
+
+    for (unsigned i = 1; i < nb_filters; i++) {
+        if ((ret = avfilter_config_links(filters[i])) < 0)
+            goto end;
+    }
+
+    av_log(graph, AV_LOG_VERBOSE, "Reconfigured %u filters downstream of %s\n",
+           nb_filters, filter->name);
+
+end:
+    av_free(filters);
+    return ret;
+}
+
 int avfilter_graph_send_command(AVFilterGraph *graph, const char *target, const char *cmd, const char *arg, char *res, int res_len, int flags)
 {
     int i, r = AVERROR(ENOSYS);
@@ -1499,17 +1910,136 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
     return 0;
 }
 
+static int ready_before(const FFFilterContext *a, const FFFilterContext *b)
+{
+    return a->p.ready >  b->p.ready ||
+          (a->p.ready == b->p.ready && a->graph_index < b->graph_index);
+}
+
+static void ready_bubble_up(FFFilterGraph *graph,
+                            FFFilterContext *ctx, int index)
+{
+    FFFilterContext **heap = graph->ready_filters;
+
+    av_assert0(index >= 0);
+
+    while (index) {
+        int parent = (index - 1) >> 1;
+        if (!ready_before(ctx, heap[parent]))
+            break;
+        heap[index] = heap[parent];
+        heap[index]->ready_index = index;
+        index = parent;
+    }
+    heap[index] = ctx;
+    ctx->ready_index = index;
+}
+
+static void ready_bubble_down(FFFilterGraph *graph,
+                              FFFilterContext *ctx, int index)
+{
+    FFFilterContext **heap = graph->ready_filters;
+
+    av_assert0(index >= 0);
+
+    while (1) {
+        int child = 2 * index + 1;
+        if (child >= graph->nb_ready_filters)
+            break;
+        if (child + 1 < graph->nb_ready_filters &&
+            ready_before(heap[child + 1], heap[child]))
+            child++;
+        if (!ready_before(heap[child], ctx))
+            break;
+        heap[index] = heap[child];
+        heap[index]->ready_index = index;
+        index = child;
+    }
+    heap[index] = ctx;
+    ctx->ready_index = index;
+}
+
+void ff_filter_graph_update_ready(AVFilterGraph *graph, AVFilterContext *filter)
+{
+    FFFilterGraph   *graphi = fffiltergraph(graph);
+    FFFilterContext *ctx    = fffilterctx(filter);
+    int index = ctx->ready_index;
+
+    if (!filter->ready) {
+        FFFilterContext *last;
+
+        if (index < 0)
+            return;
+        ctx->ready_index = -1;
+
+        last = graphi->ready_filters[--graphi->nb_ready_filters];
+        if (last == ctx)
+            return;
+        ready_bubble_up  (graphi, last, index);
+        ready_bubble_down(graphi, last, last->ready_index);
+        return;
+    }
+
+    if (index < 0) {
+        av_assert0(graphi->nb_ready_filters < graph->nb_filters);
+        index = graphi->nb_ready_filters++;
+    }
+    ready_bubble_up  (graphi, ctx, index);
+    ready_bubble_down(graphi, ctx, ctx->ready_index);
+}
+
+static void graph_update_frame_pool_stats(FFFilterGraph *graphi)
+{
+    if (graphi->frame_pool) {
+        FFGraphFramePoolStats stats;
+
+        ff_graph_frame_pool_get_stats(graphi->frame_pool, &stats);
+        graphi->frame_pool_hits      = stats.hits;
+        graphi->frame_pool_misses    = stats.misses;
+        graphi->frame_pool_evictions = stats.evictions;
+    }
+    graphi->frame_allocations = graphi->frame_pool_misses +
+        atomic_load_explicit(&graphi->link_pool_allocs, memory_order_relaxed);
+}
+
+/**
+ * Move the wakeups posted by ff_filter_set_ready_async() to the ready heap,
+ * waiting for one first if wait is set.
+ */
+static void graph_apply_async_ready(FFFilterGraph *graphi, int wait)
+{
+    AVFilterGraph *graph = &graphi->p;
+
+    ff_mutex_lock(&graphi->async_lock);
+    while (wait && !atomic_load_explicit(&graphi->async_pending, memory_order_relaxed))
+        ff_cond_wait(&graphi->async_cond, &graphi->async_lock);
+    atomic_store_explicit(&graphi->async_pending, 0, memory_order_relaxed);
+    for (unsigned i = 0; i < graph->nb_filters; i++) {
+        FFFilterContext *ctxi = fffilterctx(graph->filters[i]);
+
+        if (ctxi->async_ready) {
+            ff_filter_set_ready(&ctxi->p, ctxi->async_ready);
+            ctxi->async_ready = 0;
+        }
+    }
+    ff_mutex_unlock(&graphi->async_lock);
+}
+
 int ff_filter_graph_run_once(AVFilterGraph *graph)
 {
-    AVFilterContext *filter;
-    unsigned i;
+    FFFilterGraph *graphi = fffiltergraph(graph);
+    int ret;
 
     av_assert0(graph->nb_filters);
-    filter = graph->filters[0];
-    for (i = 1; i < graph->nb_filters; i++)
-        if (graph->filters[i]->ready > filter->ready)
-            filter = graph->filters[i];
-    if (!filter->ready)
+    if (atomic_load_explicit(&graphi->async_pending, memory_order_acquire))
+        graph_apply_async_ready(graphi, 0);
+    /* a filter waiting for its worker threads is not idle, do not ask for
+     * more input while it finishes */
+    while (!graphi->nb_ready_filters && graphi->nb_async_waiting)
+        graph_apply_async_ready(graphi, 1);
+    if (!graphi->nb_ready_filters)
         return AVERROR(EAGAIN);
-    return ff_filter_activate(filter);
+    ret = ff_filter_activate(&graphi->ready_filters[0]->p);
+    graph_update_frame_pool_stats(graphi);
+    return ret;
 }
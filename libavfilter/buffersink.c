@@ -422,6 +422,7 @@ const AVFilter ff_vsink_buffer = {
     FILTER_INPUTS(ff_video_default_filterpad),
     .outputs       = NULL,
     FILTER_QUERY_FUNC(vsink_query_formats),
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
 
 const AVFilter ff_asink_abuffer = {
@@ -607,6 +607,7 @@ const AVFilter ff_vsrc_buffer = {
     FILTER_OUTPUTS(avfilter_vsrc_buffer_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .priv_class = &buffer_class,
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
 
 static const AVFilterPad avfilter_asrc_abuffer_outputs[] = {
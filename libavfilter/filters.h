@@ -45,6 +45,31 @@
  */
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority);
 
+/**
+ * Mark a filter ready from a thread other than the one running the graph,
+ * e.g. a worker thread owned by the filter, where ff_filter_set_ready() must
+ * not be used.
+ *
+ * The thread running the graph marks the filter ready with the given
+ * priority the next time it looks for a filter to activate.
+ *
+ * @param graph the graph the filter was in when the worker thread was
+ *              started; filter->graph must not be read from other threads
+ *              since it is reset when the filter is being freed
+ */
+void ff_filter_set_ready_async(AVFilterGraph *graph, AVFilterContext *filter,
+                               unsigned priority);
+
+/**
+ * Tell whether the filter cannot make progress until one of its worker
+ * threads calls ff_filter_set_ready_async().
+ *
+ * As long as a filter of the graph is waiting, running the graph waits for
+ * such a call when no filter is ready, instead of reporting that the graph
+ * needs more input. Must be called from activate().
+ */
+void ff_filter_set_async_waiting(AVFilterContext *filter, int waiting);
+
 /**
  * Process the commands queued in the link up to the time of the frame.
  * Commands will trigger the process_command() callback.
@@ -129,6 +154,20 @@ AVFrame *ff_inlink_peek_frame(AVFilterLink *link, size_t idx);
  */
 int ff_inlink_make_frame_writable(AVFilterLink *link, AVFrame **rframe);
 
+/**
+ * Declare which planes of the video frames received on the link the
+ * destination filter modifies in place. ff_inlink_make_frame_writable(),
+ * and thus AVFILTERPAD_FLAG_NEEDS_WRITABLE, then only copies the shared
+ * buffers of those planes, and the other planes keep referencing the
+ * original data.
+ *
+ * This is usually called from the config_props callback of the input pad.
+ *
+ * @param planes bitmask of the written planes, bit n for plane n;
+ *               0 stands for all planes, which is the default
+ */
+void ff_inlink_set_writable_planes(AVFilterLink *link, unsigned planes);
+
 /**
  * Test and acknowledge the change of status on the link.
  *
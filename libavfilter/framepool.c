@@ -18,6 +18,8 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include <stdatomic.h>
+
 #include "framepool.h"
 #include "libavutil/avassert.h"
 #include "libavutil/avutil.h"
@@ -26,6 +28,7 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/mem.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/thread.h"
 
 struct FFFramePool {
 
@@ -34,6 +37,8 @@ struct FFFramePool {
     /* video */
     int width;
     int height;
+    AVBufferRef* (*alloc)(size_t size);
+    atomic_uint_least64_t *nb_allocated;
 
     /* audio */
     int planes;
@@ -48,16 +53,78 @@ struct FFFramePool {
 
 };
 
+/**
+ * Compute the linesizes and the buffer size of each plane of a video frame.
+ * Unused planes have a zero size.
+ */
+static int video_layout(int width, int height, enum AVPixelFormat format,
+                        int align, int linesize[4], size_t sizes[4])
+{
+    int i, ret;
+    ptrdiff_t linesizes[4];
+
+    if ((ret = av_image_check_size2(width, height, INT64_MAX, format, 0, NULL)) < 0)
+        return ret;
+
+    ret = av_image_fill_linesizes(linesize, format, FFALIGN(width, align));
+    if (ret < 0)
+        return ret;
+
+    for (i = 0; i < 4 && linesize[i]; i++) {
+        linesize[i] = FFALIGN(linesize[i], align);
+        if ((linesize[i] & (align - 1)))
+            return AVERROR(EINVAL);
+    }
+
+    for (i = 0; i < 4; i++)
+        linesizes[i] = linesize[i];
+
+    ret = av_image_fill_plane_sizes(sizes, format, height, linesizes);
+    if (ret < 0)
+        return ret;
+
+    for (i = 0; i < 4 && sizes[i]; i++) {
+        if (sizes[i] > SIZE_MAX - align)
+            return AVERROR(EINVAL);
+        sizes[i] += align;
+    }
+
+    return 0;
+}
+
+static int video_set_palette(AVFrame *frame, const AVPixFmtDescriptor *desc)
+{
+    enum AVPixelFormat format = frame->format;
+
+    if (!(desc->flags & AV_PIX_FMT_FLAG_PAL))
+        return 0;
+
+    if (format == AV_PIX_FMT_PAL8)
+        format = AV_PIX_FMT_BGR8;
+
+    av_assert0(frame->data[1] != NULL);
+    return avpriv_set_systematic_pal2((uint32_t *)frame->data[1], format);
+}
+
+static AVBufferRef *video_pool_alloc(void *opaque, size_t size)
+{
+    FFFramePool *pool = opaque;
+    AVBufferRef *buf = pool->alloc(size);
+
+    if (buf && pool->nb_allocated)
+        atomic_fetch_add_explicit(pool->nb_allocated, 1, memory_order_relaxed);
+    return buf;
+}
+
 FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
                                       int width,
                                       int height,
                                       enum AVPixelFormat format,
                                       int align)
 {
-    int i, ret;
+    int i;
     FFFramePool *pool;
-    ptrdiff_t linesizes[4];
-    size_t sizes[4];
+    size_t sizes[4] = { 0 };
 
     pool = av_mallocz(sizeof(FFFramePool));
     if (!pool)
@@ -68,38 +135,13 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
     pool->height = height;
     pool->format = format;
     pool->align = align;
+    pool->alloc = alloc ? alloc : av_buffer_alloc;
 
-    if ((ret = av_image_check_size2(width, height, INT64_MAX, format, 0, NULL)) < 0) {
+    if (video_layout(width, height, format, align, pool->linesize, sizes) < 0)
         goto fail;
-    }
-
-    if (!pool->linesize[0]) {
-        ret = av_image_fill_linesizes(pool->linesize, pool->format,
-                                      FFALIGN(pool->width, align));
-        if (ret < 0) {
-            goto fail;
-        }
-
-        for (i = 0; i < 4 && pool->linesize[i]; i++) {
-            pool->linesize[i] = FFALIGN(pool->linesize[i], pool->align);
-            if ((pool->linesize[i] & (pool->align - 1)))
-                goto fail;
-        }
-    }
-
-    for (i = 0; i < 4; i++)
-        linesizes[i] = pool->linesize[i];
-
-    if (av_image_fill_plane_sizes(sizes, pool->format,
-                                  pool->height,
-                                  linesizes) < 0) {
-        goto fail;
-    }
 
     for (i = 0; i < 4 && sizes[i]; i++) {
-        if (sizes[i] > SIZE_MAX - align)
-            goto fail;
-        pool->pools[i] = av_buffer_pool_init(sizes[i] + align, alloc);
+        pool->pools[i] = av_buffer_pool_init2(sizes[i], pool, video_pool_alloc, NULL);
         if (!pool->pools[i])
             goto fail;
     }
@@ -187,6 +229,13 @@ int ff_frame_pool_get_audio_config(FFFramePool *pool,
     return 0;
 }
 
+void ff_frame_pool_set_alloc_counter(FFFramePool *pool,
+                                     atomic_uint_least64_t *counter)
+{
+    av_assert0(pool->type == AVMEDIA_TYPE_VIDEO);
+    pool->nb_allocated = counter;
+}
+
 AVFrame *ff_frame_pool_get(FFFramePool *pool)
 {
     int i;
@@ -221,14 +270,8 @@ AVFrame *ff_frame_pool_get(FFFramePool *pool)
             frame->data[i] = frame->buf[i]->data;
         }
 
-        if (desc->flags & AV_PIX_FMT_FLAG_PAL) {
-            enum AVPixelFormat format =
-                pool->format == AV_PIX_FMT_PAL8 ? AV_PIX_FMT_BGR8 : pool->format;
-
-            av_assert0(frame->data[1] != NULL);
-            if (avpriv_set_systematic_pal2((uint32_t *)frame->data[1], format) < 0)
-                goto fail;
-        }
+        if (video_set_palette(frame, desc) < 0)
+            goto fail;
 
         frame->extended_data = frame->data;
         break;
@@ -293,3 +336,213 @@ void ff_frame_pool_uninit(FFFramePool **pool)
 
     av_freep(pool);
 }
+
+typedef struct PoolBuffer {
+    FFGraphFramePool *pool;
+    uint8_t *data;
+    size_t size;
+    struct PoolBuffer *prev, *next;
+} PoolBuffer;
+
+struct FFGraphFramePool {
+    AVMutex mutex;
+
+    /* one reference held by the owner, plus one per buffer in use */
+    atomic_uint refcount;
+    int closed;
+
+    int64_t max_idle_size;
+
+    /* idle buffers, the most recently released first */
+    PoolBuffer *idle_first;
+    PoolBuffer *idle_last;
+
+    FFGraphFramePoolStats stats;
+};
+
+static void pool_buffer_free(PoolBuffer *buf)
+{
+    av_free(buf->data);
+    av_free(buf);
+}
+
+static void pool_unlink(FFGraphFramePool *pool, PoolBuffer *buf)
+{
+    if (buf->prev)
+        buf->prev->next = buf->next;
+    else
+        pool->idle_first = buf->next;
+    if (buf->next)
+        buf->next->prev = buf->prev;
+    else
+        pool->idle_last = buf->prev;
+    buf->prev = buf->next = NULL;
+
+    pool->stats.idle_size -= buf->size;
+}
+
+static void pool_unref(FFGraphFramePool *pool)
+{
+    if (atomic_fetch_sub_explicit(&pool->refcount, 1, memory_order_acq_rel) == 1) {
+        av_assert1(!pool->idle_first);
+        ff_mutex_destroy(&pool->mutex);
+        av_free(pool);
+    }
+}
+
+static void pool_release_buffer(void *opaque, uint8_t *data)
+{
+    PoolBuffer *buf = opaque;
+    FFGraphFramePool *pool = buf->pool;
+
+    ff_mutex_lock(&pool->mutex);
+
+    if (pool->closed || buf->size > pool->max_idle_size) {
+        pool_buffer_free(buf);
+    } else {
+        buf->next = pool->idle_first;
+        if (pool->idle_first)
+            pool->idle_first->prev = buf;
+        else
+            pool->idle_last = buf;
+        pool->idle_first = buf;
+        pool->stats.idle_size += buf->size;
+
+        while (pool->stats.idle_size > pool->max_idle_size) {
+            PoolBuffer *lru = pool->idle_last;
+            pool_unlink(pool, lru);
+            pool_buffer_free(lru);
+            pool->stats.evictions++;
+        }
+    }
+
+    ff_mutex_unlock(&pool->mutex);
+
+    pool_unref(pool);
+}
+
+static AVBufferRef *pool_get_buffer(FFGraphFramePool *pool, size_t size)
+{
+    PoolBuffer *buf;
+    AVBufferRef *ref;
+
+    ff_mutex_lock(&pool->mutex);
+    for (buf = pool->idle_first; buf; buf = buf->next)
+        if (buf->size == size)
+            break;
+    if (buf) {
+        pool_unlink(pool, buf);
+        pool->stats.hits++;
+    } else {
+        pool->stats.misses++;
+    }
+    ff_mutex_unlock(&pool->mutex);
+
+    if (!buf) {
+        buf = av_mallocz(sizeof(*buf));
+        if (!buf)
+            return NULL;
+        buf->pool = pool;
+        buf->size = size;
+        buf->data = av_mallocz(size);
+        if (!buf->data) {
+            av_free(buf);
+            return NULL;
+        }
+    }
+
+    ref = av_buffer_create(buf->data, size, pool_release_buffer, buf, 0);
+    if (!ref) {
+        pool_buffer_free(buf);
+        return NULL;
+    }
+
+    atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
+
+    return ref;
+}
+
+FFGraphFramePool *ff_graph_frame_pool_alloc(int64_t max_idle_size)
+{
+    FFGraphFramePool *pool = av_mallocz(sizeof(*pool));
+
+    if (!pool)
+        return NULL;
+
+    if (ff_mutex_init(&pool->mutex, NULL)) {
+        av_free(pool);
+        return NULL;
+    }
+
+    atomic_init(&pool->refcount, 1);
+    pool->max_idle_size = max_idle_size;
+
+    return pool;
+}
+
+void ff_graph_frame_pool_uninit(FFGraphFramePool **ppool)
+{
+    FFGraphFramePool *pool = *ppool;
+
+    if (!pool)
+        return;
+
+    ff_mutex_lock(&pool->mutex);
+    pool->closed = 1;
+    while (pool->idle_first) {
+        PoolBuffer *buf = pool->idle_first;
+        pool_unlink(pool, buf);
+        pool_buffer_free(buf);
+    }
+    ff_mutex_unlock(&pool->mutex);
+
+    pool_unref(pool);
+    *ppool = NULL;
+}
+
+AVFrame *ff_graph_frame_pool_get_video(FFGraphFramePool *pool,
+                                       int width, int height,
+                                       enum AVPixelFormat format, int align)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(format);
+    int linesize[4] = { 0 };
+    size_t sizes[4] = { 0 };
+    AVFrame *frame;
+
+    if (!desc || video_layout(width, height, format, align, linesize, sizes) < 0)
+        return NULL;
+
+    frame = av_frame_alloc();
+    if (!frame)
+        return NULL;
+
+    frame->width  = width;
+    frame->height = height;
+    frame->format = format;
+
+    for (int i = 0; i < 4 && sizes[i]; i++) {
+        frame->linesize[i] = linesize[i];
+        frame->buf[i] = pool_get_buffer(pool, sizes[i]);
+        if (!frame->buf[i])
+            goto fail;
+        frame->data[i] = frame->buf[i]->data;
+    }
+
+    if (video_set_palette(frame, desc) < 0)
+        goto fail;
+
+    frame->extended_data = frame->data;
+
+    return frame;
+fail:
+    av_frame_free(&frame);
+    return NULL;
+}
+
+void ff_graph_frame_pool_get_stats(FFGraphFramePool *pool,
+                                   FFGraphFramePoolStats *stats)
+{
+    ff_mutex_lock(&pool->mutex);
+    *stats = pool->stats;
+    ff_mutex_unlock(&pool->mutex);
+}
@@ -21,6 +21,8 @@
 #ifndef AVFILTER_FRAMEPOOL_H
 #define AVFILTER_FRAMEPOOL_H
 
+#include <stdatomic.h>
+
 #include "libavutil/buffer.h"
 #include "libavutil/frame.h"
 #include "libavutil/internal.h"
@@ -68,6 +70,15 @@ FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(size_t size),
                                       enum AVSampleFormat format,
                                       int align);
 
+/**
+ * Count the buffers allocated by a video frame pool.
+ *
+ * @param counter incremented for every buffer the pool allocates from now on,
+ *                from whichever thread requests it; must outlive the pool
+ */
+void ff_frame_pool_set_alloc_counter(FFFramePool *pool,
+                                     atomic_uint_least64_t *counter);
+
 /**
  * Deallocate the frame pool. It is safe to call this function while
  * some of the allocated frame are still in use.
@@ -115,5 +126,60 @@ int ff_frame_pool_get_audio_config(FFFramePool *pool,
  */
 AVFrame *ff_frame_pool_get(FFFramePool *pool);
 
+/**
+ * Buffer pool shared by all the links of a filter graph. Video buffers are
+ * cached by size class, i.e. by the allocated size of each plane, so that
+ * links with identical or compatible frame geometries recycle each other's
+ * buffers. The total size of the idle buffers kept in the pool is bounded;
+ * the least recently released ones are freed first when the bound is
+ * exceeded.
+ *
+ * This structure is opaque. It is allocated with ff_graph_frame_pool_alloc()
+ * and freed with ff_graph_frame_pool_uninit().
+ */
+typedef struct FFGraphFramePool FFGraphFramePool;
+
+typedef struct FFGraphFramePoolStats {
+    int64_t hits;        ///< buffers served from the pool
+    int64_t misses;      ///< buffers that had to be allocated
+    int64_t evictions;   ///< idle buffers freed to stay within the budget
+    int64_t idle_size;   ///< total size of the idle buffers, in bytes
+} FFGraphFramePoolStats;
+
+/**
+ * Allocate a graph-wide frame pool.
+ *
+ * @param max_idle_size maximum total size in bytes of the idle buffers kept
+ *                      in the pool
+ * @return newly created pool on success, NULL on error.
+ */
+FFGraphFramePool *ff_graph_frame_pool_alloc(int64_t max_idle_size);
+
+/**
+ * Release the pool. It is safe to call this function while some of the
+ * frames allocated from it are still in use; their buffers are freed when
+ * the last reference to them is released.
+ *
+ * @param pool pointer to the pool to be freed. It will be set to NULL.
+ */
+void ff_graph_frame_pool_uninit(FFGraphFramePool **pool);
+
+/**
+ * Allocate a video frame, reusing idle buffers of the same size class when
+ * available. This function may be called simultaneously from multiple
+ * threads.
+ *
+ * @return a new AVFrame on success, NULL on error.
+ */
+AVFrame *ff_graph_frame_pool_get_video(FFGraphFramePool *pool,
+                                       int width, int height,
+                                       enum AVPixelFormat format, int align);
+
+/**
+ * Get the current statistics of the pool.
+ */
+void ff_graph_frame_pool_get_stats(FFGraphFramePool *pool,
+                                   FFGraphFramePoolStats *stats);
+
 
 #endif /* AVFILTER_FRAMEPOOL_H */
@@ -124,6 +124,27 @@ typedef struct FFFilterContext {
     // 1 when avfilter_init_*() was successfully called on this filter
     // 0 otherwise
     int initialized;
+
+    // index of this filter in AVFilterGraph.filters
+    unsigned graph_index;
+    // position in FFFilterGraph.ready_filters, -1 when not ready
+    int ready_index;
+
+    // priority posted by ff_filter_set_ready_async(), protected by
+    // FFFilterGraph.async_lock
+    unsigned async_ready;
+    // set by ff_filter_set_async_waiting()
+    int async_waiting;
+
+    // set by filters with FF_FILTER_FLAG_RECONFIGURABLE that cannot be
+    // reconfigured with their current options
+    int reconfigure_disabled;
+
+    // number of calls to ff_filter_activate(), and the total time in
+    // microseconds spent in them if the graph has filter_timing set;
+    // both are exported as read-only options
+    int64_t nb_activations;
+    int64_t activate_time;
 } FFFilterContext;
 
 static inline FFFilterContext *fffilterctx(AVFilterContext *ctx)
@@ -342,6 +363,16 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame);
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The filter supports its links being configured again with a different video
+ * frame size in an already configured graph, see avfilter_graph_reconfigure().
+ * Its config_props callbacks must then release whatever they allocated in a
+ * previous call, and any state kept across frames must remain valid. Filters
+ * holding frames of their own, or depending on their options, set
+ * FFFilterContext.reconfigure_disabled where that does not hold.
+ */
+#define FF_FILTER_FLAG_RECONFIGURABLE (1 << 1)
+
 /**
  * Run one round of processing on a filter graph.
  */
@@ -26,8 +26,11 @@
 #include <stdio.h>
 
 #include "libavutil/attributes.h"
+#include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
+#include "libavutil/fifo.h"
 #include "libavutil/internal.h"
+#include "libavutil/mem.h"
 #include "libavutil/opt.h"
 
 #include "avfilter.h"
@@ -36,11 +39,74 @@
 #include "internal.h"
 #include "video.h"
 
+enum SplitPolicy {
+    POLICY_BLOCK,
+    POLICY_DROP_OLDEST,
+    POLICY_DROP_NEWEST,
+};
+
+static const char *const policy_names[] = {
+    [POLICY_BLOCK]       = "block",
+    [POLICY_DROP_OLDEST] = "drop_oldest",
+    [POLICY_DROP_NEWEST] = "drop_newest",
+};
+
+typedef struct SplitOutput {
+    AVFifo *queue;              ///< frames not yet requested by the output
+    enum SplitPolicy policy;    ///< what to do when the queue is full
+    uint64_t nb_sent;
+    uint64_t nb_dropped;
+    size_t peak;                ///< highest number of frames held in the queue
+} SplitOutput;
+
 typedef struct SplitContext {
     const AVClass *class;
     int nb_outputs;
+    int queue_size;
+    char *policies;
+
+    SplitOutput *out;
+    int status;                 ///< input status, once acknowledged
+    int64_t status_pts;
 } SplitContext;
 
+static int parse_policies(AVFilterContext *ctx)
+{
+    SplitContext *s = ctx->priv;
+    char *policies, *saveptr = NULL, *p;
+    int i = 0, ret = 0;
+
+    if (!s->policies)
+        return 0;
+
+    policies = av_strdup(s->policies);
+    if (!policies)
+        return AVERROR(ENOMEM);
+
+    for (p = av_strtok(policies, "|", &saveptr); p;
+         p = av_strtok(NULL, "|", &saveptr), i++) {
+        int j;
+
+        if (i >= s->nb_outputs) {
+            av_log(ctx, AV_LOG_ERROR, "More policies than outputs specified\n");
+            ret = AVERROR(EINVAL);
+            break;
+        }
+        for (j = 0; j < FF_ARRAY_ELEMS(policy_names); j++)
+            if (!strcmp(p, policy_names[j]))
+                break;
+        if (j == FF_ARRAY_ELEMS(policy_names)) {
+            av_log(ctx, AV_LOG_ERROR, "Unknown policy '%s' for output %d\n", p, i);
+            ret = AVERROR(EINVAL);
+            break;
+        }
+        s->out[i].policy = j;
+    }
+
+    av_free(policies);
+    return ret;
+}
+
 static av_cold int split_init(AVFilterContext *ctx)
 {
     SplitContext *s = ctx->priv;
@@ -58,16 +124,176 @@ static av_cold int split_init(AVFilterContext *ctx)
             return ret;
     }
 
+    if (!s->queue_size)
+        return 0;
+
+    /* the queued frames would reach outputs already configured for the
+     * new frame size */
+    fffilterctx(ctx)->reconfigure_disabled = 1;
+
+    s->out = av_calloc(s->nb_outputs, sizeof(*s->out));
+    if (!s->out)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < s->nb_outputs; i++) {
+        s->out[i].queue = av_fifo_alloc2(s->queue_size, sizeof(AVFrame *), 0);
+        if (!s->out[i].queue)
+            return AVERROR(ENOMEM);
+    }
+
+    return parse_policies(ctx);
+}
+
+static void flush_queue(SplitOutput *o)
+{
+    AVFrame *frame;
+
+    while (av_fifo_read(o->queue, &frame, 1) >= 0)
+        av_frame_free(&frame);
+}
+
+static av_cold void split_uninit(AVFilterContext *ctx)
+{
+    SplitContext *s = ctx->priv;
+
+    if (!s->out)
+        return;
+
+    for (int i = 0; i < s->nb_outputs; i++) {
+        SplitOutput *o = &s->out[i];
+
+        if (!o->queue)
+            continue;
+        av_log(ctx, AV_LOG_VERBOSE, "output%d (%s): %"PRIu64" frames sent, "
+               "%"PRIu64" dropped, at most %zu queued\n", i, policy_names[o->policy],
+               o->nb_sent, o->nb_dropped, o->peak);
+        flush_queue(o);
+        av_fifo_freep2(&o->queue);
+    }
+    av_freep(&s->out);
+}
+
+static int queue_frame(AVFilterContext *ctx, AVFrame *in)
+{
+    SplitContext *s = ctx->priv;
+
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        SplitOutput *o = &s->out[i];
+        AVFrame *frame;
+
+        if (ff_outlink_get_status(ctx->outputs[i]))
+            continue;
+
+        if (!av_fifo_can_write(o->queue)) {
+            /* blocking outputs are never full when the input is consumed */
+            av_assert1(o->policy != POLICY_BLOCK);
+            o->nb_dropped++;
+            if (o->policy == POLICY_DROP_NEWEST)
+                continue;
+            av_fifo_read(o->queue, &frame, 1);
+            av_frame_free(&frame);
+        }
+
+        frame = av_frame_clone(in);
+        if (!frame)
+            return AVERROR(ENOMEM);
+        av_fifo_write(o->queue, &frame, 1);
+        o->peak = FFMAX(o->peak, av_fifo_can_read(o->queue));
+    }
+
     return 0;
 }
 
+/**
+ * Queued mode: every output gets its own bounded queue of references to the
+ * input frames, and is only sent a frame when it requests one. The input is
+ * read as long as no output with the block policy has a full queue, so a
+ * slow output that may drop frames never holds back the others.
+ */
+static int activate_queued(AVFilterContext *ctx)
+{
+    SplitContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+    int ret, status, nb_eofs = 0, blocked = 0, wanted = 0;
+    AVFrame *in;
+    int64_t pts;
+
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        AVFilterLink *outlink = ctx->outputs[i];
+        SplitOutput *o = &s->out[i];
+        AVFrame *frame;
+
+        if (ff_outlink_get_status(outlink)) {
+            flush_queue(o);
+            nb_eofs++;
+            continue;
+        }
+
+        if (ff_outlink_frame_wanted(outlink) &&
+            av_fifo_read(o->queue, &frame, 1) >= 0) {
+            o->nb_sent++;
+            ret = ff_filter_frame(outlink, frame);
+            if (ret < 0)
+                return ret;
+        }
+
+        if (av_fifo_can_read(o->queue)) {
+            if (!av_fifo_can_write(o->queue) && o->policy == POLICY_BLOCK)
+                blocked = 1;
+        } else if (s->status) {
+            ff_outlink_set_status(outlink, s->status, s->status_pts);
+        } else {
+            wanted |= ff_outlink_frame_wanted(outlink);
+        }
+    }
+
+    if (nb_eofs == ctx->nb_outputs) {
+        if (!s->status)
+            ff_inlink_set_status(inlink, AVERROR_EOF);
+        return 0;
+    }
+
+    if (blocked || s->status)
+        return FFERROR_NOT_READY;
+
+    ret = ff_inlink_consume_frame(inlink, &in);
+    if (ret < 0)
+        return ret;
+    if (ret > 0) {
+        ret = queue_frame(ctx, in);
+        av_frame_free(&in);
+        if (ret < 0)
+            return ret;
+        ff_filter_set_ready(ctx, 100);
+        return 0;
+    }
+
+    if (ff_inlink_acknowledge_status(inlink, &status, &pts)) {
+        s->status     = status;
+        s->status_pts = pts;
+        ff_filter_set_ready(ctx, 100);
+        return 0;
+    }
+
+    if (wanted) {
+        ff_inlink_request_frame(inlink);
+        return 0;
+    }
+
+    return FFERROR_NOT_READY;
+}
+
 static int activate(AVFilterContext *ctx)
 {
+    SplitContext *s = ctx->priv;
     AVFilterLink *inlink = ctx->inputs[0];
     AVFrame *in;
     int status, ret, nb_eofs = 0;
     int64_t pts;
 
+    if (s->queue_size)
+        return activate_queued(ctx);
+
     for (int i = 0; i < ctx->nb_outputs; i++)
         nb_eofs += ff_outlink_get_status(ctx->outputs[i]) == AVERROR_EOF;
 
@@ -127,6 +353,8 @@ static int activate(AVFilterContext *ctx)
 #define FLAGS (AV_OPT_FLAG_AUDIO_PARAM | AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_FILTERING_PARAM)
 static const AVOption options[] = {
     { "outputs", "set number of outputs", OFFSET(nb_outputs), AV_OPT_TYPE_INT, { .i64 = 2 }, 1, INT_MAX, FLAGS },
+    { "queue_size", "set the number of frames queued per output, 0 to send frames to all outputs at once", OFFSET(queue_size), AV_OPT_TYPE_INT, { .i64 = 0 }, 0, INT_MAX, FLAGS },
+    { "policies", "set the '|'-separated policies for full output queues: block, drop_oldest or drop_newest", OFFSET(policies), AV_OPT_TYPE_STRING, { .str = NULL }, 0, 0, FLAGS },
     { NULL }
 };
 
@@ -138,10 +366,12 @@ const AVFilter ff_vf_split = {
     .priv_size   = sizeof(SplitContext),
     .priv_class  = &split_class,
     .init        = split_init,
+    .uninit      = split_uninit,
     .activate    = activate,
     FILTER_INPUTS(ff_video_default_filterpad),
     .outputs     = NULL,
     .flags       = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_METADATA_ONLY,
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
 
 const AVFilter ff_af_asplit = {
@@ -150,6 +380,7 @@ const AVFilter ff_af_asplit = {
     .priv_class  = &split_class,
     .priv_size   = sizeof(SplitContext),
     .init        = split_init,
+    .uninit      = split_uninit,
     .activate    = activate,
     FILTER_INPUTS(ff_audio_default_filterpad),
     .outputs     = NULL,
@@ -0,0 +1,274 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Change the frame size in the middle of a stream and reconfigure the graph
+ * in place with avfilter_graph_reconfigure(). The frames filtered after the
+ * change must match those of a graph built for the new size.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/adler32.h"
+#include "libavutil/common.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/pixdesc.h"
+
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+#define NB_FRAMES  4
+#define MAX_FRAMES (2 * NB_FRAMES)
+
+static const char *const chains[] = {
+    "crop=iw-8:ih-4,scale=iw*3/2:ih*3/2:flags=bicubic+accurate_rnd+bitexact,hflip,pad=iw+16:ih+16:8:8",
+    "vflip,split=1,setsar=2/3",
+    "vflip,split=1:queue_size=2,setsar=2/3",
+};
+
+static const struct {
+    int w, h;
+} sizes[] = {
+    { 64, 48 },
+    { 96, 80 },
+};
+
+typedef struct Output {
+    int w[MAX_FRAMES], h[MAX_FRAMES];
+    uint32_t checksum[MAX_FRAMES];
+    int nb_frames;
+} Output;
+
+static int build_graph(AVFilterGraph **graph, AVFilterContext **src,
+                       AVFilterContext **sink, const char *chain, int w, int h)
+{
+    AVFilterInOut *in = NULL, *out = NULL;
+    char args[256];
+    int ret;
+
+    *graph = avfilter_graph_alloc();
+    if (!*graph)
+        return AVERROR(ENOMEM);
+
+    snprintf(args, sizeof(args),
+             "video_size=%dx%d:pix_fmt=yuv420p:time_base=1/25:pixel_aspect=1/1", w, h);
+    ret = avfilter_graph_create_filter(src, avfilter_get_by_name("buffer"),
+                                       "in", args, NULL, *graph);
+    if (ret < 0)
+        return ret;
+    ret = avfilter_graph_create_filter(sink, avfilter_get_by_name("buffersink"),
+                                       "out", NULL, NULL, *graph);
+    if (ret < 0)
+        return ret;
+
+    out = avfilter_inout_alloc();
+    in  = avfilter_inout_alloc();
+    if (!out || !in) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    out->name       = av_strdup("in");
+    out->filter_ctx = *src;
+    in->name        = av_strdup("out");
+    in->filter_ctx  = *sink;
+    if (!out->name || !in->name) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    ret = avfilter_graph_parse_ptr(*graph, chain, &in, &out, NULL);
+    if (ret < 0)
+        goto end;
+    ret = avfilter_graph_config(*graph, NULL);
+
+end:
+    avfilter_inout_free(&in);
+    avfilter_inout_free(&out);
+    return ret;
+}
+
+static int receive_frames(AVFilterContext *sink, Output *out)
+{
+    AVFrame *frame = av_frame_alloc();
+    int ret;
+
+    if (!frame)
+        return AVERROR(ENOMEM);
+
+    while ((ret = av_buffersink_get_frame(sink, frame)) >= 0) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(frame->format);
+        uint32_t checksum = 0;
+
+        for (int p = 0; p < 3; p++) {
+            int w = p ? AV_CEIL_RSHIFT(frame->width,  desc->log2_chroma_w) : frame->width;
+            int h = p ? AV_CEIL_RSHIFT(frame->height, desc->log2_chroma_h) : frame->height;
+
+            for (int y = 0; y < h; y++)
+                checksum = av_adler32_update(checksum, frame->data[p] + y * frame->linesize[p], w);
+        }
+        if (out->nb_frames < MAX_FRAMES) {
+            out->w[out->nb_frames] = frame->width;
+            out->h[out->nb_frames] = frame->height;
+            out->checksum[out->nb_frames] = checksum;
+        }
+        out->nb_frames++;
+        av_frame_unref(frame);
+    }
+
+    av_frame_free(&frame);
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int send_frame(AVFilterContext *src, int w, int h, int n)
+{
+    AVFrame *frame = av_frame_alloc();
+    int ret;
+
+    if (!frame)
+        return AVERROR(ENOMEM);
+
+    frame->format = AV_PIX_FMT_YUV420P;
+    frame->width  = w;
+    frame->height = h;
+    frame->pts    = n;
+    frame->sample_aspect_ratio = (AVRational){ 1, 1 };
+    ret = av_frame_get_buffer(frame, 0);
+    if (ret < 0)
+        goto end;
+
+    for (int p = 0; p < 3; p++) {
+        int pw = p ? AV_CEIL_RSHIFT(w, 1) : w;
+        int ph = p ? AV_CEIL_RSHIFT(h, 1) : h;
+
+        for (int y = 0; y < ph; y++)
+            for (int x = 0; x < pw; x++)
+                frame->data[p][y * frame->linesize[p] + x] = x * (3 + p) + y * 5 + n * 7;
+    }
+
+    ret = av_buffersrc_add_frame(src, frame);
+end:
+    av_frame_free(&frame);
+    return ret;
+}
+
+/**
+ * Filter NB_FRAMES frames of each size. With in_place set, the size change
+ * is done on the same graph when possible, otherwise a new graph is built.
+ */
+static int run(const char *chain, int in_place, Output *out, int *reconfigured)
+{
+    AVFilterGraph *graph = NULL;
+    AVFilterContext *src, *sink;
+    int ret, n = 0;
+
+    *reconfigured = 0;
+    out->nb_frames = 0;
+
+    ret = build_graph(&graph, &src, &sink, chain, sizes[0].w, sizes[0].h);
+    for (int i = 0; ret >= 0 && i < NB_FRAMES; i++) {
+        if ((ret = send_frame(src, sizes[0].w, sizes[0].h, n++)) >= 0)
+            ret = receive_frames(sink, out);
+    }
+    if (ret < 0)
+        goto end;
+
+    if (in_place) {
+        AVBufferSrcParameters *par = av_buffersrc_parameters_alloc();
+
+        if (!par) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
+        par->width  = sizes[1].w;
+        par->height = sizes[1].h;
+        ret = av_buffersrc_parameters_set(src, par);
+        av_free(par);
+        if (ret >= 0)
+            ret = avfilter_graph_reconfigure(graph, src);
+        if (ret >= 0)
+            *reconfigured = 1;
+        else if (ret != AVERROR(ENOSYS))
+            goto end;
+    }
+
+    if (!*reconfigured) {
+        /* flush the old graph before replacing it */
+        if ((ret = av_buffersrc_add_frame(src, NULL)) < 0 ||
+            (ret = receive_frames(sink, out)) < 0)
+            goto end;
+        avfilter_graph_free(&graph);
+        ret = build_graph(&graph, &src, &sink, chain, sizes[1].w, sizes[1].h);
+    }
+
+    for (int i = 0; ret >= 0 && i < NB_FRAMES; i++) {
+        if ((ret = send_frame(src, sizes[1].w, sizes[1].h, n++)) >= 0)
+            ret = receive_frames(sink, out);
+    }
+    if (ret >= 0)
+        ret = av_buffersrc_add_frame(src, NULL);
+    if (ret >= 0)
+        ret = receive_frames(sink, out);
+
+end:
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+int main(void)
+{
+    Output *out = av_calloc(2, sizeof(*out));
+    int ret = 0;
+
+    if (!out)
+        return 1;
+
+    for (int c = 0; c < FF_ARRAY_ELEMS(chains); c++) {
+        int reconfigured, rebuilt, err;
+
+        printf("%s\n", chains[c]);
+
+        err = run(chains[c], 1, &out[0], &reconfigured);
+        if (err >= 0)
+            err = run(chains[c], 0, &out[1], &rebuilt);
+        if (err < 0) {
+            printf("  failed: %s\n", av_err2str(err));
+            ret = 1;
+            continue;
+        }
+
+        printf("  %s\n", reconfigured ? "reconfigured in place" : "rebuilt");
+        for (int i = 0; i < FFMIN(out[0].nb_frames, MAX_FRAMES); i++)
+            printf("  frame %d: %dx%d 0x%08"PRIx32"\n", i,
+                   out[0].w[i], out[0].h[i], out[0].checksum[i]);
+
+        if (out[0].nb_frames != out[1].nb_frames ||
+            memcmp(out[0].w, out[1].w, sizeof(out[0].w)) ||
+            memcmp(out[0].h, out[1].h, sizeof(out[0].h)) ||
+            memcmp(out[0].checksum, out[1].checksum, sizeof(out[0].checksum))) {
+            printf("  output differs from a rebuilt graph\n");
+            ret = 1;
+        }
+    }
+
+    av_free(out);
+    return ret;
+}
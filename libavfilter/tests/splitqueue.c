@@ -0,0 +1,173 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Feed a split with queued outputs, reading the first output after every
+ * input frame and the second one only after every SLOW_PERIOD input frames,
+ * and print which frames each output received and when.
+ */
+
+#include <stdio.h>
+
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/macros.h"
+
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+#define NB_FRAMES   10
+#define SLOW_PERIOD 4
+
+static const char *const policies[] = {
+    "block",
+    "drop_oldest",
+    "drop_newest",
+};
+
+static int build_graph(AVFilterGraph **graph, AVFilterContext **src,
+                       AVFilterContext *sink[2], const char *policy)
+{
+    AVFilterContext *split;
+    char args[64];
+    int ret;
+
+    *graph = avfilter_graph_alloc();
+    if (!*graph)
+        return AVERROR(ENOMEM);
+
+    ret = avfilter_graph_create_filter(src, avfilter_get_by_name("buffer"), "in",
+                                       "video_size=16x16:pix_fmt=gray:time_base=1/25",
+                                       NULL, *graph);
+    if (ret < 0)
+        return ret;
+
+    snprintf(args, sizeof(args), "outputs=2:queue_size=2:policies=block|%s", policy);
+    ret = avfilter_graph_create_filter(&split, avfilter_get_by_name("split"),
+                                       "split", args, NULL, *graph);
+    if (ret < 0)
+        return ret;
+    ret = avfilter_link(*src, 0, split, 0);
+    if (ret < 0)
+        return ret;
+
+    for (int i = 0; i < 2; i++) {
+        char name[8];
+
+        snprintf(name, sizeof(name), "out%d", i);
+        ret = avfilter_graph_create_filter(&sink[i], avfilter_get_by_name("buffersink"),
+                                           name, NULL, NULL, *graph);
+        if (ret < 0)
+            return ret;
+        ret = avfilter_link(split, i, sink[i], 0);
+        if (ret < 0)
+            return ret;
+    }
+
+    return avfilter_graph_config(*graph, NULL);
+}
+
+static int send_frame(AVFilterContext *src, int n)
+{
+    AVFrame *frame = av_frame_alloc();
+    int ret;
+
+    if (!frame)
+        return AVERROR(ENOMEM);
+
+    frame->format = AV_PIX_FMT_GRAY8;
+    frame->width  = 16;
+    frame->height = 16;
+    frame->pts    = n;
+    ret = av_frame_get_buffer(frame, 0);
+    if (ret >= 0)
+        ret = av_buffersrc_add_frame(src, frame);
+
+    av_frame_free(&frame);
+    return ret;
+}
+
+/* print the pts of all frames the output can return right now */
+static int drain(AVFilterContext *sink, int idx)
+{
+    AVFrame *frame = av_frame_alloc();
+    int ret;
+
+    if (!frame)
+        return AVERROR(ENOMEM);
+
+    printf(" out%d:", idx);
+    while ((ret = av_buffersink_get_frame(sink, frame)) >= 0) {
+        printf(" %"PRId64, frame->pts);
+        av_frame_unref(frame);
+    }
+    if (ret == AVERROR_EOF)
+        printf(" eof");
+
+    av_frame_free(&frame);
+    return ret == AVERROR(EAGAIN) || ret == AVERROR_EOF ? 0 : ret;
+}
+
+static int run(const char *policy)
+{
+    AVFilterGraph *graph = NULL;
+    AVFilterContext *src, *sink[2];
+    int ret;
+
+    ret = build_graph(&graph, &src, sink, policy);
+
+    for (int n = 0; ret >= 0 && n <= NB_FRAMES; n++) {
+        if (n < NB_FRAMES) {
+            printf("  in %d:", n);
+            ret = send_frame(src, n);
+        } else {
+            printf("  in eof:");
+            ret = av_buffersrc_add_frame(src, NULL);
+        }
+        if (ret >= 0)
+            ret = drain(sink[0], 0);
+        if (ret >= 0 && (n % SLOW_PERIOD == SLOW_PERIOD - 1 || n == NB_FRAMES))
+            ret = drain(sink[1], 1);
+        /* the fast output may have been unblocked by the slow one */
+        if (ret >= 0)
+            ret = drain(sink[0], 0);
+        printf("\n");
+    }
+
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+int main(void)
+{
+    int ret = 0;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(policies); i++) {
+        int err;
+
+        printf("block|%s\n", policies[i]);
+        err = run(policies[i]);
+        if (err < 0) {
+            printf("  failed: %s\n", av_err2str(err));
+            ret = 1;
+        }
+    }
+
+    return ret;
+}
@@ -195,6 +195,7 @@ const AVFilter ff_vf_setdar = {
     .flags       = AVFILTER_FLAG_METADATA_ONLY,
     FILTER_INPUTS(aspect_inputs),
     FILTER_OUTPUTS(avfilter_vf_setdar_outputs),
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
 
 #endif /* CONFIG_SETDAR_FILTER */
@@ -250,6 +251,7 @@ const AVFilter ff_vf_setsar = {
     .flags       = AVFILTER_FLAG_METADATA_ONLY,
     FILTER_INPUTS(aspect_inputs),
     FILTER_OUTPUTS(avfilter_vf_setsar_outputs),
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
 
 #endif /* CONFIG_SETSAR_FILTER */
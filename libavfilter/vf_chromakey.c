@@ -22,6 +22,7 @@
 #include "libavutil/intreadwrite.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
+#include "filters.h"
 #include "internal.h"
 
 typedef struct ChromakeyContext {
@@ -308,6 +309,10 @@ static av_cold int config_input(AVFilterLink *inlink)
     ctx->hsub_log2 = desc->log2_chroma_w;
     ctx->vsub_log2 = desc->log2_chroma_h;
 
+    /* chromakey only writes the alpha plane, chromahold the chroma planes */
+    ff_inlink_set_writable_planes(inlink, !strcmp(avctx->filter->name, "chromakey") ?
+                                          1 << 3 : (1 << 1) | (1 << 2));
+
     return 0;
 }
 
@@ -73,4 +73,5 @@ const AVFilter ff_vf_copy = {
     FILTER_INPUTS(avfilter_vf_copy_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_QUERY_FUNC(query_formats),
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
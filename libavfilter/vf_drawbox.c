@@ -216,6 +216,52 @@ static void draw_region_rgb_packed(AVFrame *frame, DrawBoxContext *ctx, int left
     }
 }
 
+typedef struct ThreadData {
+    AVFrame *frame;
+    int left, top, right, down;
+    PixelBelongsToRegion pixel_belongs_to_region;
+} ThreadData;
+
+static int draw_region_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DrawBoxContext *s = ctx->priv;
+    ThreadData *td = arg;
+    const int h = td->down - td->top;
+    /* Slices start on chroma row boundaries, so that the luma rows sharing
+     * a chroma row are always processed by the same job, in order. */
+    const int vmask = (1 << s->vsub) - 1;
+    int slice_start = td->top + (h *  jobnr     ) / nb_jobs;
+    int slice_end   = td->top + (h * (jobnr + 1)) / nb_jobs;
+
+    if (jobnr)
+        slice_start = FFMAX(slice_start & ~vmask, td->top);
+    if (jobnr < nb_jobs - 1)
+        slice_end   = FFMAX(slice_end   & ~vmask, td->top);
+
+    s->draw_region(td->frame, s, td->left, slice_start, td->right, slice_end,
+                   td->pixel_belongs_to_region);
+
+    return 0;
+}
+
+static void draw_region_threaded(AVFilterContext *ctx, AVFrame *frame,
+                                 int left, int top, int right, int down,
+                                 PixelBelongsToRegion pixel_belongs_to_region)
+{
+    ThreadData td = {
+        .frame = frame,
+        .left  = left,  .top  = top,
+        .right = right, .down = down,
+        .pixel_belongs_to_region = pixel_belongs_to_region,
+    };
+
+    if (right <= left || down <= top)
+        return;
+
+    ff_filter_execute(ctx, draw_region_slice, &td, NULL,
+                      FFMIN(down - top, ff_filter_get_nb_threads(ctx)));
+}
+
 static enum AVFrameSideDataType box_source_string_parse(const char *box_source_string)
 {
     av_assert0(box_source_string);
@@ -371,7 +417,8 @@ static av_pure av_always_inline int pixel_belongs_to_box(DrawBoxContext *s, int
 
 static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
 {
-    DrawBoxContext *s = inlink->dst->priv;
+    AVFilterContext *ctx = inlink->dst;
+    DrawBoxContext *s = ctx->priv;
     const AVDetectionBBoxHeader *header = NULL;
     const AVDetectionBBox *bbox;
     AVFrameSideData *sd;
@@ -397,8 +444,9 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *frame)
             s->w = bbox->w;
         }
 
-        s->draw_region(frame, s, FFMAX(s->x, 0), FFMAX(s->y, 0), FFMIN(s->x + s->w, frame->width),
-                       FFMIN(s->y + s->h, frame->height), pixel_belongs_to_box);
+        draw_region_threaded(ctx, frame, FFMAX(s->x, 0), FFMAX(s->y, 0),
+                             FFMIN(s->x + s->w, frame->width),
+                             FFMIN(s->y + s->h, frame->height), pixel_belongs_to_box);
     }
 
     return ff_filter_frame(inlink->dst->outputs[0], frame);
@@ -480,7 +528,7 @@ const AVFilter ff_vf_drawbox = {
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
     .process_command = process_command,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
 };
 #endif /* CONFIG_DRAWBOX_FILTER */
 
@@ -511,9 +559,8 @@ static av_pure av_always_inline int pixel_belongs_to_grid(DrawBoxContext *drawgr
 
 static int drawgrid_filter_frame(AVFilterLink *inlink, AVFrame *frame)
 {
-    DrawBoxContext *drawgrid = inlink->dst->priv;
-
-    drawgrid->draw_region(frame, drawgrid, 0, 0, frame->width, frame->height, pixel_belongs_to_grid);
+    draw_region_threaded(inlink->dst, frame, 0, 0, frame->width, frame->height,
+                         pixel_belongs_to_grid);
 
     return ff_filter_frame(inlink->dst->outputs[0], frame);
 }
@@ -554,7 +601,7 @@ const AVFilter ff_vf_drawgrid = {
     FILTER_INPUTS(drawgrid_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC | AVFILTER_FLAG_SLICE_THREADS,
     .process_command = process_command,
 };
 
@@ -1272,7 +1272,12 @@ static void update_alpha(DrawTextContext *s)
         s->alpha = 256 * alpha;
 }
 
+/**
+ * Draw the glyphs of the text, restricted to the rows [slice_start, slice_end)
+ * of the frame. data must point to the first row of the slice in each plane.
+ */
 static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
+                       uint8_t *data[4], int slice_start, int slice_end,
                        FFDrawColor *color,
                        TextMetrics *metrics,
                        int x, int y, int borderw)
@@ -1298,13 +1303,9 @@ static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
         offset_y = s->box_height - metrics->height;
     }
 
-    if ((!j_left || j_right) && !s->tab_warning_printed && s->tab_count > 0) {
-        s->tab_warning_printed = 1;
-        av_log(s, AV_LOG_WARNING, "Tab characters are only supported with left horizontal alignment\n");
-    }
-
     clip_x = FFMIN(metrics->rect_x + s->box_width + s->bb_right, frame->width);
     clip_y = FFMIN(metrics->rect_y + s->box_height + s->bb_bottom, frame->height);
+    clip_y = FFMIN(clip_y, slice_end);
 
     for (l = 0; l < s->line_count; ++l) {
         TextLine *line = &s->lines[l];
@@ -1344,7 +1345,8 @@ static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
             }
 
             // check if the glyph is empty or out of the clipping region
-            if (dx >= w1 || dy >= h1 || x1 >= clip_x || y1 >= clip_y) {
+            if (dx >= w1 || dy >= h1 || x1 >= clip_x || y1 >= clip_y ||
+                y1 + h1 - dy <= slice_start) {
                 continue;
             }
 
@@ -1352,14 +1354,63 @@ static int draw_glyphs(DrawTextContext *s, AVFrame *frame,
             w1 = FFMIN(clip_x - x1, w1 - dx);
             h1 = FFMIN(clip_y - y1, h1 - dy);
 
-            ff_blend_mask(&s->dc, color, frame->data, frame->linesize, clip_x, clip_y,
-                bitmap.buffer + pdx, bitmap.pitch, w1, h1, 3, 0, x1, y1);
+            ff_blend_mask(&s->dc, color, data, frame->linesize,
+                clip_x, clip_y - slice_start,
+                bitmap.buffer + pdx, bitmap.pitch, w1, h1, 3, 0,
+                x1, y1 - slice_start);
         }
     }
 
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *frame;
+    TextMetrics *metrics;
+    FFDrawColor *fontcolor, *shadowcolor, *bordercolor, *boxcolor;
+    int rec_x, rec_y, rec_width, rec_height;
+} ThreadData;
+
+static int draw_text_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    DrawTextContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *frame = td->frame;
+    const int vmask = (1 << s->dc.vsub_max) - 1;
+    const int slice_start = (frame->height *  jobnr     / nb_jobs) & ~vmask;
+    const int slice_end   = jobnr == nb_jobs - 1 ? frame->height :
+                            (frame->height * (jobnr + 1) / nb_jobs) & ~vmask;
+    uint8_t *data[4] = { NULL };
+    int ret;
+
+    if (slice_start >= slice_end)
+        return 0;
+
+    for (int i = 0; i < s->dc.nb_planes; i++)
+        data[i] = frame->data[i] + (slice_start >> s->dc.vsub[i]) * frame->linesize[i];
+
+    if (s->draw_box)
+        ff_blend_rectangle(&s->dc, td->boxcolor,
+            data, frame->linesize, frame->width, slice_end - slice_start,
+            td->rec_x, td->rec_y - slice_start, td->rec_width, td->rec_height);
+
+    if (s->shadowx || s->shadowy) {
+        if ((ret = draw_glyphs(s, frame, data, slice_start, slice_end,
+                td->shadowcolor, td->metrics,
+                s->shadowx, s->shadowy, s->borderw)) < 0)
+            return ret;
+    }
+
+    if (s->borderw) {
+        if ((ret = draw_glyphs(s, frame, data, slice_start, slice_end,
+                td->bordercolor, td->metrics, 0, 0, s->borderw)) < 0)
+            return ret;
+    }
+
+    return draw_glyphs(s, frame, data, slice_start, slice_end,
+                       td->fontcolor, td->metrics, 0, 0, 0);
+}
+
 // Shapes a line of text using libharfbuzz
 static int shape_text_hb(DrawTextContext *s, HarfbuzzData* hb, const char* text, int textLen)
 {
@@ -1574,7 +1625,6 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame)
 
     int width = frame->width;
     int height = frame->height;
-    int rec_x = 0, rec_y = 0, rec_width = 0, rec_height = 0;
     int is_outside = 0;
     int last_tab_idx = 0;
 
@@ -1788,35 +1838,42 @@ static int draw_text(AVFilterContext *ctx, AVFrame *frame)
                     metrics.rect_y + s->box_height + s->bb_bottom <= 0;
 
     if (!is_outside) {
-        /* draw box */
-        if (s->draw_box) {
-            rec_x = metrics.rect_x - s->bb_left;
-            rec_y = metrics.rect_y - s->bb_top;
-            rec_width = s->box_width + s->bb_right + s->bb_left;
-            rec_height = s->box_height + s->bb_bottom + s->bb_top;
-            ff_blend_rectangle(&s->dc, &boxcolor,
-                frame->data, frame->linesize, width, height,
-                rec_x, rec_y, rec_width, rec_height);
+        ThreadData td = {
+            .frame       = frame,
+            .metrics     = &metrics,
+            .fontcolor   = &fontcolor,
+            .shadowcolor = &shadowcolor,
+            .bordercolor = &bordercolor,
+            .boxcolor    = &boxcolor,
+        };
+        int nb_jobs = av_clip(height >> s->dc.vsub_max, 1,
+                              ff_filter_get_nb_threads(ctx));
+
+        int *job_ret;
+
+        if ((!(s->text_align & TA_LEFT) || (s->text_align & TA_RIGHT)) &&
+            !s->tab_warning_printed && s->tab_count > 0) {
+            s->tab_warning_printed = 1;
+            av_log(s, AV_LOG_WARNING, "Tab characters are only supported with left horizontal alignment\n");
         }
 
-        if (s->shadowx || s->shadowy) {
-            if ((ret = draw_glyphs(s, frame, &shadowcolor, &metrics,
-                    s->shadowx, s->shadowy, s->borderw)) < 0) {
-                return ret;
-            }
-        }
-
-        if (s->borderw) {
-            if ((ret = draw_glyphs(s, frame, &bordercolor, &metrics,
-                    0, 0, s->borderw)) < 0) {
-                return ret;
-            }
+        if (s->draw_box) {
+            td.rec_x      = metrics.rect_x - s->bb_left;
+            td.rec_y      = metrics.rect_y - s->bb_top;
+            td.rec_width  = s->box_width + s->bb_right + s->bb_left;
+            td.rec_height = s->box_height + s->bb_bottom + s->bb_top;
         }
 
-        if ((ret = draw_glyphs(s, frame, &fontcolor, &metrics, 0,
-                0, 0)) < 0) {
+        job_ret = av_calloc(nb_jobs, sizeof(*job_ret));
+        if (!job_ret)
+            return AVERROR(ENOMEM);
+        ff_filter_execute(ctx, draw_text_slice, &td, job_ret, nb_jobs);
+        ret = 0;
+        for (int i = 0; i < nb_jobs; i++)
+            ret = FFMIN(ret, job_ret[i]);
+        av_free(job_ret);
+        if (ret < 0)
             return ret;
-        }
     }
 
     // FREE data structures
@@ -1929,5 +1986,6 @@ const AVFilter ff_vf_drawtext = {
     FILTER_OUTPUTS(ff_video_default_filterpad),
     FILTER_QUERY_FUNC(query_formats),
     .process_command = command,
-    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags         = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC |
+                     AVFILTER_FLAG_SLICE_THREADS,
 };
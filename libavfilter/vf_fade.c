@@ -33,6 +33,7 @@
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
 #include "drawutils.h"
+#include "filters.h"
 #include "formats.h"
 #include "internal.h"
 #include "video.h"
@@ -437,6 +438,9 @@ static int config_input(AVFilterLink *inlink)
     s->filter_slice_chroma = s->depth <= 8 ? filter_slice_chroma : filter_slice_chroma16;
     s->filter_slice_alpha  = s->depth <= 8 ? filter_slice_alpha  : filter_slice_alpha16;
 
+    if (s->alpha && s->is_planar)
+        ff_inlink_set_writable_planes(inlink, 1 << pixdesc->comp[3].plane);
+
     return 0;
 }
 
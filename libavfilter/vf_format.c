@@ -183,6 +183,7 @@ const AVFilter ff_vf_format = {
     FILTER_OUTPUTS(ff_video_default_filterpad),
 
     FILTER_QUERY_FUNC(query_formats),
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
 #endif /* CONFIG_FORMAT_FILTER */
 
@@ -203,5 +204,6 @@ const AVFilter ff_vf_noformat = {
     FILTER_OUTPUTS(ff_video_default_filterpad),
 
     FILTER_QUERY_FUNC(query_formats),
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
 #endif /* CONFIG_NOFORMAT_FILTER */
@@ -21,6 +21,7 @@
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
 #include "avfilter.h"
+#include "filters.h"
 #include "internal.h"
 #include "video.h"
 
@@ -125,6 +126,9 @@ static int config_input(AVFilterLink *inlink)
         s->so = s->softness * s->max;
     }
 
+    /* only the alpha plane is written */
+    ff_inlink_set_writable_planes(inlink, 1 << 3);
+
     return 0;
 }
 
@@ -32,4 +32,5 @@ const AVFilter ff_vf_null = {
     .flags       = AVFILTER_FLAG_METADATA_ONLY,
     FILTER_INPUTS(ff_video_default_filterpad),
     FILTER_OUTPUTS(ff_video_default_filterpad),
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
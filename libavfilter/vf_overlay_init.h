@@ -0,0 +1,167 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_OVERLAY_INIT_H
+#define AVFILTER_OVERLAY_INIT_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "config.h"
+#include "libavutil/attributes.h"
+#include "libavutil/pixdesc.h"
+#include "vf_overlay.h"
+
+// divide by 255 and round to nearest
+// apply a fast variant: (X+127)/255 = ((X+127)*257+257)>>16 = ((X+128)*257)>>16
+#define FAST_DIV255(x) ((((x) + 128) * 257) >> 16)
+
+/*
+ * Row kernels for straight alpha on a main input without alpha. They must
+ * match the generic per-pixel code of blend_plane_*() bit for bit, and
+ * return the number of samples they handled; the remainder of the row is
+ * left to the generic code. The subsampled variants stop one sample short
+ * because the last chroma sample of the overlay has no right neighbour to
+ * average its alpha with.
+ */
+
+static int overlay_row_44_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                            int w, ptrdiff_t alinesize)
+{
+    for (int x = 0; x < w; x++)
+        d[x] = FAST_DIV255(d[x] * (255 - a[x]) + s[x] * a[x]);
+    return w;
+}
+
+static int overlay_row_22_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                            int w, ptrdiff_t alinesize)
+{
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (((a[2 * x] + a[2 * x + 1]) >> 1) + a[2 * x]) >> 1;
+        d[x] = FAST_DIV255(d[x] * (255 - alpha) + s[x] * alpha);
+    }
+    return x;
+}
+
+static int overlay_row_20_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                            int w, ptrdiff_t alinesize)
+{
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (a[2 * x]             + a[2 * x + 1] +
+                     a[2 * x + alinesize] + a[2 * x + alinesize + 1]) >> 2;
+        d[x] = FAST_DIV255(d[x] * (255 - alpha) + s[x] * alpha);
+    }
+    return x;
+}
+
+/* same as overlay_row_20_c(), for the interleaved chroma of NV12/NV21 */
+static int overlay_row_20_nv12_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                                 int w, ptrdiff_t alinesize)
+{
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (a[2 * x]             + a[2 * x + 1] +
+                     a[2 * x + alinesize] + a[2 * x + alinesize + 1]) >> 2;
+        d[2 * x] = FAST_DIV255(d[2 * x] * (255 - alpha) + s[x] * alpha);
+    }
+    return x;
+}
+
+static int overlay_row_44_10_c(uint8_t *dd, uint8_t *dda, uint8_t *ss, uint8_t *aa,
+                               int w, ptrdiff_t alinesize)
+{
+    uint16_t *d = (uint16_t *)dd;
+    const uint16_t *s = (const uint16_t *)ss;
+    const uint16_t *a = (const uint16_t *)aa;
+
+    for (int x = 0; x < w; x++)
+        d[x] = (d[x] * (1023 - a[x]) + s[x] * a[x]) / 1023;
+    return w;
+}
+
+static int overlay_row_22_10_c(uint8_t *dd, uint8_t *dda, uint8_t *ss, uint8_t *aa,
+                               int w, ptrdiff_t alinesize)
+{
+    uint16_t *d = (uint16_t *)dd;
+    const uint16_t *s = (const uint16_t *)ss;
+    const uint16_t *a = (const uint16_t *)aa;
+    int x;
+
+    for (x = 0; x < w - 1; x++) {
+        int alpha = (((a[2 * x] + a[2 * x + 1]) >> 1) + a[2 * x]) >> 1;
+        d[x] = (d[x] * (1023 - alpha) + s[x] * alpha) / 1023;
+    }
+    return x;
+}
+
+static av_unused void ff_overlay_init(OverlayContext *s, int format, int pix_format,
+                                      int alpha_format, int main_has_alpha)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_format);
+    int interleaved = desc->nb_components >= 3 &&
+                      desc->comp[1].plane == desc->comp[2].plane;
+
+    memset(s->blend_row, 0, sizeof(s->blend_row));
+
+    if (alpha_format || main_has_alpha)
+        return;
+
+    switch (format) {
+    case OVERLAY_FORMAT_YUV420:
+        s->blend_row[0] = overlay_row_44_c;
+        s->blend_row[1] = interleaved ? overlay_row_20_nv12_c : overlay_row_20_c;
+        s->blend_row[2] = interleaved ? overlay_row_20_nv12_c : overlay_row_20_c;
+        break;
+    case OVERLAY_FORMAT_YUV420P10:
+        s->blend_row[0] = overlay_row_44_10_c;
+        break;
+    case OVERLAY_FORMAT_YUV422:
+        s->blend_row[0] = overlay_row_44_c;
+        s->blend_row[1] = overlay_row_22_c;
+        s->blend_row[2] = overlay_row_22_c;
+        break;
+    case OVERLAY_FORMAT_YUV422P10:
+        s->blend_row[0] = overlay_row_44_10_c;
+        s->blend_row[1] = overlay_row_22_10_c;
+        s->blend_row[2] = overlay_row_22_10_c;
+        break;
+    case OVERLAY_FORMAT_YUV444:
+    case OVERLAY_FORMAT_GBRP:
+        s->blend_row[0] = overlay_row_44_c;
+        s->blend_row[1] = overlay_row_44_c;
+        s->blend_row[2] = overlay_row_44_c;
+        break;
+    case OVERLAY_FORMAT_YUV444P10:
+        s->blend_row[0] = overlay_row_44_10_c;
+        s->blend_row[1] = overlay_row_44_10_c;
+        s->blend_row[2] = overlay_row_44_10_c;
+        break;
+    }
+
+#if ARCH_X86
+    ff_overlay_init_x86(s, format, pix_format, alpha_format, main_has_alpha);
+#endif
+}
+
+#endif /* AVFILTER_OVERLAY_INIT_H */
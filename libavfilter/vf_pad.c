@@ -320,11 +320,67 @@ static int frame_needs_copy(PadContext *s, AVFrame *frame)
     return 0;
 }
 
+typedef struct ThreadData {
+    AVFrame *in, *out;
+    int needs_copy;
+} ThreadData;
+
+/* Fill the part of the rectangle x,y,w,h lying in the rows [y0, y1). */
+static void fill_slice(PadContext *s, AVFrame *out, int x, int y, int w, int h,
+                       int y0, int y1)
+{
+    int top    = FFMAX(y, y0);
+    int bottom = FFMIN(y + h, y1);
+
+    if (w > 0 && bottom > top)
+        ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
+                          x, top, w, bottom - top);
+}
+
+static int pad_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    PadContext *s = ctx->priv;
+    ThreadData *td = arg;
+    AVFrame *in  = td->in;
+    AVFrame *out = td->out;
+    /* keep slice boundaries on chroma rows */
+    const int vmask = (1 << s->draw.vsub_max) - 1;
+    const int y0 =                        ((s->h *  jobnr     ) / nb_jobs) & ~vmask;
+    const int y1 = jobnr == nb_jobs - 1 ? s->h :
+                                          ((s->h * (jobnr + 1)) / nb_jobs) & ~vmask;
+
+    /* top bar */
+    fill_slice(s, out, 0, 0, s->w, s->y, y0, y1);
+
+    /* bottom bar */
+    fill_slice(s, out, 0, s->y + s->in_h, s->w, s->h - s->y - s->in_h, y0, y1);
+
+    /* left border */
+    fill_slice(s, out, 0, s->y, s->x, in->height, y0, y1);
+
+    if (td->needs_copy) {
+        int top    = FFMAX(s->y, y0);
+        int bottom = FFMIN(s->y + in->height, y1);
+
+        if (bottom > top)
+            ff_copy_rectangle2(&s->draw,
+                               out->data, out->linesize, in->data, in->linesize,
+                               s->x, top, 0, top - s->y, in->width, bottom - top);
+    }
+
+    /* right border */
+    fill_slice(s, out, s->x + s->in_w, s->y, s->w - s->x - s->in_w, in->height,
+               y0, y1);
+
+    return 0;
+}
+
 static int filter_frame(AVFilterLink *inlink, AVFrame *in)
 {
     PadContext *s = inlink->dst->priv;
     AVFilterLink *outlink = inlink->dst->outputs[0];
     AVFrame *out;
+    ThreadData td;
     int needs_copy;
     if(s->eval_mode == EVAL_MODE_FRAME && (
            in->width  != s->inlink_w
@@ -376,34 +432,12 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         }
     }
 
-    /* top bar */
-    if (s->y) {
-        ff_fill_rectangle(&s->draw, &s->color,
-                          out->data, out->linesize,
-                          0, 0, s->w, s->y);
-    }
-
-    /* bottom bar */
-    if (s->h > s->y + s->in_h) {
-        ff_fill_rectangle(&s->draw, &s->color,
-                          out->data, out->linesize,
-                          0, s->y + s->in_h, s->w, s->h - s->y - s->in_h);
-    }
-
-    /* left border */
-    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
-                      0, s->y, s->x, in->height);
-
-    if (needs_copy) {
-        ff_copy_rectangle2(&s->draw,
-                          out->data, out->linesize, in->data, in->linesize,
-                          s->x, s->y, 0, 0, in->width, in->height);
-    }
-
-    /* right border */
-    ff_fill_rectangle(&s->draw, &s->color, out->data, out->linesize,
-                      s->x + s->in_w, s->y, s->w - s->x - s->in_w,
-                      in->height);
+    td.in         = in;
+    td.out        = out;
+    td.needs_copy = needs_copy;
+    ff_filter_execute(inlink->dst, pad_slice, &td, NULL,
+                      av_clip(s->h >> s->draw.vsub_max, 1,
+                              ff_filter_get_nb_threads(inlink->dst)));
 
     out->width  = s->w;
     out->height = s->h;
@@ -459,4 +493,6 @@ const AVFilter ff_vf_pad = {
     FILTER_INPUTS(avfilter_vf_pad_inputs),
     FILTER_OUTPUTS(avfilter_vf_pad_outputs),
     FILTER_QUERY_FUNC(query_formats),
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
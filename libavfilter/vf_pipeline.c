@@ -0,0 +1,556 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * run a filter chain as a frame-level pipeline
+ *
+ * The chain is cut into stages, each of which is a separate filtergraph
+ * driven by its own thread. Consecutive stages are connected by bounded
+ * FIFOs, so every stage works on a different frame at the same time while
+ * frames leave the pipeline in the order they entered it. Inside a stage
+ * filters are activated exactly as in a regular graph.
+ *
+ * activate() never blocks: the stage threads wake the filter up with
+ * ff_filter_set_ready_async() when a frame leaves the pipeline or makes room
+ * to enter it.
+ */
+
+#include "libavutil/avstring.h"
+#include "libavutil/fifo.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/thread.h"
+
+#include "avfilter.h"
+#include "buffersink.h"
+#include "buffersrc.h"
+#include "filters.h"
+#include "formats.h"
+#include "internal.h"
+#include "video.h"
+
+typedef struct PipelineStage {
+    struct PipelineContext *parent;
+
+    char            *desc;
+    AVFilterGraph   *graph;
+    AVFilterContext *src;
+    AVFilterContext *sink;
+
+    /* frames waiting to enter this stage, a NULL entry signals EOF */
+    AVFifo          *queue;
+
+    pthread_t        thread;
+    int              thread_started;
+} PipelineStage;
+
+typedef struct PipelineContext {
+    const AVClass *class;
+
+    /* the filter and its graph, for waking it up from the stage threads */
+    AVFilterContext *ctx;
+    AVFilterGraph   *graph;
+
+    char *stages_str;
+    int   queue_size;
+
+    PipelineStage *stages;
+    int         nb_stages;
+
+    /* frames that went through all the stages */
+    AVFifo        *out_queue;
+
+    /* protects all the queues and err */
+    pthread_mutex_t lock;
+    pthread_cond_t  cond;
+    int             lock_initialized;
+    /* set by a stage on failure or by uninit() to stop all stages */
+    int             err;
+
+    int             eof_in;
+    int             eof_out;
+    int64_t         eof_pts;
+} PipelineContext;
+
+static av_cold int init(AVFilterContext *ctx)
+{
+    PipelineContext *s = ctx->priv;
+    const char *p = s->stages_str;
+    int ret;
+
+    while (p && *p) {
+        char *desc = av_get_token(&p, "|");
+        PipelineStage *st;
+
+        if (!desc)
+            return AVERROR(ENOMEM);
+        if (*p)
+            p++;
+        if (!*desc) {
+            av_free(desc);
+            continue;
+        }
+
+        st = av_dynarray2_add((void**)&s->stages, &s->nb_stages,
+                              sizeof(*s->stages), NULL);
+        if (!st) {
+            av_free(desc);
+            return AVERROR(ENOMEM);
+        }
+        memset(st, 0, sizeof(*st));
+        st->parent = s;
+        st->desc   = desc;
+
+        st->graph = avfilter_graph_alloc();
+        if (!st->graph)
+            return AVERROR(ENOMEM);
+
+        st->queue = av_fifo_alloc2(s->queue_size, sizeof(AVFrame*), 0);
+        if (!st->queue)
+            return AVERROR(ENOMEM);
+    }
+
+    if (!s->nb_stages) {
+        av_log(ctx, AV_LOG_ERROR, "No stages specified\n");
+        return AVERROR(EINVAL);
+    }
+
+    s->out_queue = av_fifo_alloc2(s->queue_size, sizeof(AVFrame*), 0);
+    if (!s->out_queue)
+        return AVERROR(ENOMEM);
+
+    ret = pthread_mutex_init(&s->lock, NULL);
+    if (ret)
+        return AVERROR(ret);
+    ret = pthread_cond_init(&s->cond, NULL);
+    if (ret) {
+        pthread_mutex_destroy(&s->lock);
+        return AVERROR(ret);
+    }
+    s->lock_initialized = 1;
+
+    return 0;
+}
+
+static void queue_free(AVFifo **pqueue)
+{
+    AVFrame *frame;
+
+    if (!*pqueue)
+        return;
+    while (av_fifo_read(*pqueue, &frame, 1) >= 0)
+        av_frame_free(&frame);
+    av_fifo_freep2(pqueue);
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    PipelineContext *s = ctx->priv;
+
+    if (s->lock_initialized) {
+        pthread_mutex_lock(&s->lock);
+        s->err = AVERROR_EXIT;
+        pthread_cond_broadcast(&s->cond);
+        pthread_mutex_unlock(&s->lock);
+    }
+
+    for (int i = 0; i < s->nb_stages; i++) {
+        PipelineStage *st = &s->stages[i];
+
+        if (st->thread_started)
+            pthread_join(st->thread, NULL);
+        avfilter_graph_free(&st->graph);
+        av_freep(&st->desc);
+        queue_free(&st->queue);
+    }
+    av_freep(&s->stages);
+    queue_free(&s->out_queue);
+
+    if (s->lock_initialized) {
+        pthread_cond_destroy(&s->cond);
+        pthread_mutex_destroy(&s->lock);
+    }
+}
+
+static int query_formats(AVFilterContext *ctx)
+{
+    /* each stage converts internally whatever it needs, so the pipeline
+     * itself accepts any software format and keeps it */
+    return ff_set_common_formats(ctx,
+                                 ff_formats_pixdesc_filter(0, AV_PIX_FMT_FLAG_HWACCEL |
+                                                              AV_PIX_FMT_FLAG_BITSTREAM));
+}
+
+static int stage_build(AVFilterContext *ctx, PipelineStage *st,
+                       const AVBufferSrcParameters *par, int last)
+{
+    AVFilterGraph *graph = st->graph;
+    AVFilterInOut *inputs = NULL, *outputs = NULL;
+    const char *desc = st->desc;
+    int ret;
+
+    graph->nb_threads  = ctx->graph->nb_threads;
+    graph->thread_type = ctx->graph->thread_type;
+
+    st->src = avfilter_graph_alloc_filter(graph, avfilter_get_by_name("buffer"), "in");
+    if (!st->src)
+        return AVERROR(ENOMEM);
+    ret = av_buffersrc_parameters_set(st->src, (AVBufferSrcParameters*)par);
+    if (ret < 0)
+        return ret;
+    ret = avfilter_init_dict(st->src, NULL);
+    if (ret < 0)
+        return ret;
+
+    st->sink = avfilter_graph_alloc_filter(graph, avfilter_get_by_name("buffersink"), "out");
+    if (!st->sink)
+        return AVERROR(ENOMEM);
+    if (last) {
+        /* the output of the last stage must match what was negotiated on
+         * our output link */
+        AVFilterLink *outlink = ctx->outputs[0];
+        enum AVPixelFormat fmt = outlink->format;
+        enum AVColorSpace  csp = outlink->colorspace;
+        enum AVColorRange  rng = outlink->color_range;
+
+        ret = av_opt_set_bin(st->sink, "pix_fmts", (const uint8_t*)&fmt,
+                             sizeof(fmt), AV_OPT_SEARCH_CHILDREN);
+        if (ret >= 0)
+            ret = av_opt_set_bin(st->sink, "color_spaces", (const uint8_t*)&csp,
+                                 sizeof(csp), AV_OPT_SEARCH_CHILDREN);
+        if (ret >= 0)
+            ret = av_opt_set_bin(st->sink, "color_ranges", (const uint8_t*)&rng,
+                                 sizeof(rng), AV_OPT_SEARCH_CHILDREN);
+        if (ret < 0)
+            return ret;
+    }
+    ret = avfilter_init_dict(st->sink, NULL);
+    if (ret < 0)
+        return ret;
+
+    ret = avfilter_graph_parse2(graph, desc, &inputs, &outputs);
+    if (ret < 0)
+        goto fail;
+
+    if (!inputs || inputs->next || !outputs || outputs->next) {
+        av_log(ctx, AV_LOG_ERROR, "Stage '%s' must have exactly one input "
+               "and one output\n", desc);
+        ret = AVERROR(EINVAL);
+        goto fail;
+    }
+
+    ret = avfilter_link(st->src, 0, inputs->filter_ctx, inputs->pad_idx);
+    if (ret < 0)
+        goto fail;
+    ret = avfilter_link(outputs->filter_ctx, outputs->pad_idx, st->sink, 0);
+    if (ret < 0)
+        goto fail;
+
+    ret = avfilter_graph_config(graph, ctx);
+
+fail:
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    return ret;
+}
+
+static int config_output(AVFilterLink *outlink)
+{
+    AVFilterContext *ctx = outlink->src;
+    PipelineContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+    AVBufferSrcParameters par = {
+        .format              = inlink->format,
+        .time_base           = inlink->time_base,
+        .width               = inlink->w,
+        .height              = inlink->h,
+        .sample_aspect_ratio = inlink->sample_aspect_ratio,
+        .frame_rate          = inlink->frame_rate,
+        .color_space         = inlink->colorspace,
+        .color_range         = inlink->color_range,
+    };
+    int ret;
+
+    s->ctx   = ctx;
+    s->graph = ctx->graph;
+
+    for (int i = 0; i < s->nb_stages; i++) {
+        PipelineStage *st = &s->stages[i];
+
+        ret = stage_build(ctx, st, &par, i == s->nb_stages - 1);
+        if (ret < 0)
+            return ret;
+
+        par.format              = av_buffersink_get_format(st->sink);
+        par.time_base           = av_buffersink_get_time_base(st->sink);
+        par.width               = av_buffersink_get_w(st->sink);
+        par.height              = av_buffersink_get_h(st->sink);
+        par.sample_aspect_ratio = av_buffersink_get_sample_aspect_ratio(st->sink);
+        par.frame_rate          = av_buffersink_get_frame_rate(st->sink);
+        par.color_space         = av_buffersink_get_colorspace(st->sink);
+        par.color_range         = av_buffersink_get_color_range(st->sink);
+    }
+
+    outlink->w                   = par.width;
+    outlink->h                   = par.height;
+    outlink->time_base           = par.time_base;
+    outlink->sample_aspect_ratio = par.sample_aspect_ratio;
+    outlink->frame_rate          = par.frame_rate;
+
+    return 0;
+}
+
+/* Wake up the filter from a stage thread. */
+static void pipeline_wakeup(PipelineContext *s)
+{
+    ff_filter_set_ready_async(s->graph, s->ctx, 10);
+}
+
+/* Push a frame to the given queue, waiting until there is room for it.
+ * Must be called with the lock held. */
+static int queue_push_locked(PipelineContext *s, AVFifo *queue, AVFrame *frame)
+{
+    while (!s->err && !av_fifo_can_write(queue))
+        pthread_cond_wait(&s->cond, &s->lock);
+    if (s->err)
+        return s->err;
+
+    av_fifo_write(queue, &frame, 1);
+    pthread_cond_broadcast(&s->cond);
+    return 0;
+}
+
+static int stage_run(PipelineContext *s, PipelineStage *st, AVFifo *next)
+{
+    AVFrame *frame;
+    int ret;
+
+    while (1) {
+        pthread_mutex_lock(&s->lock);
+        while (!s->err && !av_fifo_can_read(st->queue))
+            pthread_cond_wait(&s->cond, &s->lock);
+        ret = s->err;
+        if (!ret) {
+            av_fifo_read(st->queue, &frame, 1);
+            pthread_cond_broadcast(&s->cond);
+        }
+        pthread_mutex_unlock(&s->lock);
+        if (ret)
+            return ret;
+        /* there is room for the next input frame */
+        if (st == s->stages)
+            pipeline_wakeup(s);
+
+        /* a NULL frame closes the source */
+        ret = av_buffersrc_add_frame(st->src, frame);
+        av_frame_free(&frame);
+        if (ret < 0)
+            return ret;
+
+        while (1) {
+            frame = av_frame_alloc();
+            if (!frame)
+                return AVERROR(ENOMEM);
+
+            ret = av_buffersink_get_frame(st->sink, frame);
+            if (ret < 0) {
+                av_frame_free(&frame);
+                if (ret == AVERROR(EAGAIN))
+                    break;
+                if (ret != AVERROR_EOF)
+                    return ret;
+                /* forward EOF to the next stage */
+            }
+
+            pthread_mutex_lock(&s->lock);
+            ret = queue_push_locked(s, next, frame);
+            pthread_mutex_unlock(&s->lock);
+            if (ret < 0) {
+                av_frame_free(&frame);
+                return ret;
+            }
+            if (next == s->out_queue)
+                pipeline_wakeup(s);
+            if (!frame)
+                return 0;
+        }
+    }
+}
+
+static void *stage_thread(void *arg)
+{
+    PipelineStage   *st = arg;
+    PipelineContext *s  = st->parent;
+    int idx = st - s->stages;
+    AVFifo *next = idx == s->nb_stages - 1 ? s->out_queue : s->stages[idx + 1].queue;
+    int ret;
+
+    ret = stage_run(s, st, next);
+    if (ret < 0) {
+        pthread_mutex_lock(&s->lock);
+        if (!s->err)
+            s->err = ret;
+        pthread_cond_broadcast(&s->cond);
+        pthread_mutex_unlock(&s->lock);
+        /* report the error */
+        pipeline_wakeup(s);
+    }
+
+    return NULL;
+}
+
+static int start_threads(AVFilterContext *ctx)
+{
+    PipelineContext *s = ctx->priv;
+
+    for (int i = 0; i < s->nb_stages; i++) {
+        PipelineStage *st = &s->stages[i];
+        int ret;
+
+        if (st->thread_started)
+            continue;
+
+        ret = pthread_create(&st->thread, NULL, stage_thread, st);
+        if (ret) {
+            av_log(ctx, AV_LOG_ERROR, "Could not start stage thread: %s\n",
+                   av_err2str(AVERROR(ret)));
+            return AVERROR(ret);
+        }
+        st->thread_started = 1;
+    }
+
+    return 0;
+}
+
+static int activate(AVFilterContext *ctx)
+{
+    PipelineContext *s = ctx->priv;
+    AVFilterLink *inlink  = ctx->inputs[0];
+    AVFilterLink *outlink = ctx->outputs[0];
+    AVFifo *in_queue = s->stages[0].queue;
+    AVFrame *frame = NULL;
+    int ret, status, have_out, can_write;
+    int64_t pts;
+
+    ff_filter_set_async_waiting(ctx, 0);
+
+    FF_FILTER_FORWARD_STATUS_BACK(outlink, inlink);
+
+    if (s->eof_out)
+        return FFERROR_NOT_READY;
+
+    ret = start_threads(ctx);
+    if (ret < 0)
+        return ret;
+
+    pthread_mutex_lock(&s->lock);
+    ret       = s->err;
+    have_out  = av_fifo_can_read(s->out_queue);
+    can_write = av_fifo_can_write(in_queue);
+    if (!ret && have_out) {
+        av_fifo_read(s->out_queue, &frame, 1);
+        pthread_cond_broadcast(&s->cond);
+    }
+    pthread_mutex_unlock(&s->lock);
+    if (ret < 0)
+        return ret;
+
+    if (have_out) {
+        if (!frame) {
+            s->eof_out = 1;
+            ff_outlink_set_status(outlink, AVERROR_EOF,
+                                  av_rescale_q(s->eof_pts, inlink->time_base,
+                                               outlink->time_base));
+            return 0;
+        }
+        /* there may be more output or room for more input */
+        ff_filter_set_ready(ctx, 10);
+        return ff_filter_frame(outlink, frame);
+    }
+
+    if (!s->eof_in && can_write) {
+        ret = ff_inlink_consume_frame(inlink, &frame);
+        if (ret < 0)
+            return ret;
+        if (!ret && ff_inlink_acknowledge_status(inlink, &status, &pts)) {
+            s->eof_in  = 1;
+            s->eof_pts = pts;
+            /* frame is NULL here, which signals EOF to the first stage */
+            ret = 1;
+        }
+        if (ret > 0) {
+            /* only activate() writes to the input queue, so there is still
+             * room for the frame */
+            pthread_mutex_lock(&s->lock);
+            av_fifo_write(in_queue, &frame, 1);
+            pthread_cond_broadcast(&s->cond);
+            pthread_mutex_unlock(&s->lock);
+            ff_filter_set_ready(ctx, 10);
+            return 0;
+        }
+    }
+
+    /* When the input is finished or the pipeline is full, only the stages
+     * can make progress: make the graph wait for them instead of asking for
+     * more input. */
+    if (s->eof_in || !can_write) {
+        ff_filter_set_async_waiting(ctx, 1);
+        return FFERROR_NOT_READY;
+    }
+
+    FF_FILTER_FORWARD_WANTED(outlink, inlink);
+
+    return FFERROR_NOT_READY;
+}
+
+#define OFFSET(x) offsetof(PipelineContext, x)
+#define FLAGS AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_FILTERING_PARAM
+
+static const AVOption pipeline_options[] = {
+    { "stages", "'|'-separated list of filter chains, one per pipeline stage",
+        OFFSET(stages_str), AV_OPT_TYPE_STRING, { .str = NULL }, .flags = FLAGS },
+    { "queue_size", "number of frames buffered between two stages",
+        OFFSET(queue_size), AV_OPT_TYPE_INT, { .i64 = 2 }, 1, 64, FLAGS },
+    { NULL }
+};
+
+AVFILTER_DEFINE_CLASS(pipeline);
+
+static const AVFilterPad pipeline_outputs[] = {
+    {
+        .name         = "default",
+        .type         = AVMEDIA_TYPE_VIDEO,
+        .config_props = config_output,
+    },
+};
+
+const AVFilter ff_vf_pipeline = {
+    .name          = "pipeline",
+    .description   = NULL_IF_CONFIG_SMALL("Run a filter chain as a multithreaded frame pipeline."),
+    .priv_size     = sizeof(PipelineContext),
+    .priv_class    = &pipeline_class,
+    .init          = init,
+    .uninit        = uninit,
+    .activate      = activate,
+    FILTER_INPUTS(ff_video_default_filterpad),
+    FILTER_OUTPUTS(pipeline_outputs),
+    FILTER_QUERY_FUNC(query_formats),
+};
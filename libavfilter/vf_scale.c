@@ -102,6 +102,9 @@ enum var_name {
     VARS_NB
 };
 
+/* frames smaller than this are scaled on a single thread by default */
+#define SLICE_THREADS_MIN_PIXELS (1280 * 720)
+
 enum EvalMode {
     EVAL_MODE_INIT,
     EVAL_MODE_FRAME,
@@ -306,7 +309,6 @@ static const int sws_colorspaces[] = {
 static av_cold int init(AVFilterContext *ctx)
 {
     ScaleContext *scale = ctx->priv;
-    int64_t threads;
     int ret;
 
     if (scale->size_str && (scale->w_expr || scale->h_expr)) {
@@ -373,13 +375,6 @@ static av_cold int init(AVFilterContext *ctx)
                 return ret;
         }
 
-    // use generic thread-count if the user did not set it explicitly
-    ret = av_opt_get_int(scale->sws_opts, "threads", 0, &threads);
-    if (ret < 0)
-        return ret;
-    if (!threads)
-        av_opt_set_int(scale->sws_opts, "threads", ff_filter_get_nb_threads(ctx), 0);
-
     return 0;
 }
 
@@ -530,6 +525,28 @@ fail:
     return ret;
 }
 
+typedef struct ExecuteArg {
+    void (*func)(void *arg, int jobnr, int nb_jobs);
+    void *arg;
+} ExecuteArg;
+
+static int scale_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    const ExecuteArg *e = arg;
+
+    e->func(e->arg, jobnr, nb_jobs);
+    return 0;
+}
+
+/* run the swscale slice jobs on the filtergraph threads */
+static int scale_execute(void *opaque, void (*func)(void *arg, int jobnr, int nb_jobs),
+                         void *arg, int nb_jobs)
+{
+    ExecuteArg e = { func, arg };
+
+    return ff_filter_execute(opaque, scale_slice, &e, NULL, nb_jobs);
+}
+
 static int config_props(AVFilterLink *outlink)
 {
     AVFilterContext *ctx = outlink->src;
@@ -595,6 +612,7 @@ static int config_props(AVFilterLink *outlink)
         for (i = 0; i < 3; i++) {
             int in_v_chr_pos = scale->in_v_chr_pos, out_v_chr_pos = scale->out_v_chr_pos;
             int in_full, out_full, brightness, contrast, saturation;
+            int64_t threads;
             const int *inv_table, *table;
             struct SwsContext *const s = sws_alloc_context();
             if (!s)
@@ -605,6 +623,20 @@ static int config_props(AVFilterLink *outlink)
             if (ret < 0)
                 return ret;
 
+            // use the filtergraph threads for large frames, unless the user
+            // set a thread count explicitly
+            ret = av_opt_get_int(s, "threads", 0, &threads);
+            if (ret < 0)
+                return ret;
+            if (!threads) {
+                int64_t pixels = FFMAX((int64_t)inlink0->w * inlink0->h,
+                                       (int64_t)outlink->w * outlink->h);
+                threads = pixels >= SLICE_THREADS_MIN_PIXELS ?
+                          ff_filter_get_nb_threads(ctx) : 1;
+                av_opt_set_int(s, "threads", threads, 0);
+            }
+            sws_set_executor(s, scale_execute, ctx);
+
             av_opt_set_int(s, "srcw", inlink0 ->w, 0);
             av_opt_set_int(s, "srch", inlink0 ->h >> !!i, 0);
             av_opt_set_int(s, "src_format", inlink0->format, 0);
@@ -1076,6 +1108,8 @@ const AVFilter ff_vf_scale = {
     FILTER_OUTPUTS(avfilter_vf_scale_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .process_command = process_command,
+    .flags           = AVFILTER_FLAG_SLICE_THREADS,
+    .flags_internal  = FF_FILTER_FLAG_RECONFIGURABLE,
 };
 
 static const AVFilterPad avfilter_vf_scale2ref_inputs[] = {
@@ -1118,4 +1152,5 @@ const AVFilter ff_vf_scale2ref = {
     FILTER_OUTPUTS(avfilter_vf_scale2ref_outputs),
     FILTER_QUERY_FUNC(query_formats),
     .process_command = process_command,
+    .flags           = AVFILTER_FLAG_SLICE_THREADS,
 };
@@ -0,0 +1,426 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * scale a video to several sizes at once
+ *
+ * Every output is scaled from the next larger one instead of the input, so
+ * the full resolution source is read only once per frame no matter how many
+ * renditions are produced. The horizontal pass itself is not shared between
+ * outputs of the same width, since libswscale does not expose its
+ * intermediate lines.
+ */
+
+#include "libavutil/avstring.h"
+#include "libavutil/internal.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libswscale/swscale.h"
+
+#include "avfilter.h"
+#include "filters.h"
+#include "formats.h"
+#include "internal.h"
+#include "video.h"
+
+typedef struct LadderLevel {
+    int w, h;
+
+    /* one scaler per slice job, all sharing the same geometry */
+    struct SwsContext **sws;
+    int              nb_sws;
+    int               *sws_ret;
+} LadderLevel;
+
+typedef struct ScaleLadderContext {
+    const AVClass *class;
+
+    char *sizes_str;
+    char *flags_str;
+
+    LadderLevel *levels;
+    int       nb_levels;
+
+    AVFrame    **frames;
+} ScaleLadderContext;
+
+typedef struct ThreadData {
+    const AVFrame *in;
+    AVFrame       *out;
+    LadderLevel   *level;
+} ThreadData;
+
+static int config_output(AVFilterLink *outlink);
+
+static av_cold int init(AVFilterContext *ctx)
+{
+    ScaleLadderContext *s = ctx->priv;
+    char *sizes, *size, *saveptr = NULL;
+    int ret = 0;
+
+    sizes = av_strdup(s->sizes_str);
+    if (!sizes)
+        return AVERROR(ENOMEM);
+
+    for (size = av_strtok(sizes, "|", &saveptr); size;
+         size = av_strtok(NULL, "|", &saveptr)) {
+        LadderLevel *level;
+        AVFilterPad pad = { 0 };
+
+        level = av_dynarray2_add((void **)&s->levels, &s->nb_levels,
+                                 sizeof(*s->levels), NULL);
+        if (!level) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+        memset(level, 0, sizeof(*level));
+
+        ret = av_parse_video_size(&level->w, &level->h, size);
+        if (ret < 0) {
+            av_log(ctx, AV_LOG_ERROR, "Invalid size '%s'\n", size);
+            goto fail;
+        }
+
+        if (s->nb_levels > 1 &&
+            (level->w > level[-1].w || level->h > level[-1].h)) {
+            av_log(ctx, AV_LOG_ERROR, "Size %dx%d is larger than the "
+                   "preceding size %dx%d, sizes must be given in "
+                   "decreasing order\n",
+                   level->w, level->h, level[-1].w, level[-1].h);
+            ret = AVERROR(EINVAL);
+            goto fail;
+        }
+
+        pad.type         = AVMEDIA_TYPE_VIDEO;
+        pad.config_props = config_output;
+        pad.name         = av_asprintf("output%d", s->nb_levels - 1);
+        if (!pad.name) {
+            ret = AVERROR(ENOMEM);
+            goto fail;
+        }
+
+        ret = ff_append_outpad_free_name(ctx, &pad);
+        if (ret < 0)
+            goto fail;
+    }
+
+    if (!s->nb_levels) {
+        av_log(ctx, AV_LOG_ERROR, "No output sizes specified\n");
+        ret = AVERROR(EINVAL);
+        goto fail;
+    }
+
+    s->frames = av_calloc(s->nb_levels, sizeof(*s->frames));
+    if (!s->frames)
+        ret = AVERROR(ENOMEM);
+
+fail:
+    av_freep(&sizes);
+    return ret;
+}
+
+static void free_level(LadderLevel *level)
+{
+    for (int i = 0; i < level->nb_sws; i++)
+        sws_freeContext(level->sws[i]);
+    av_freep(&level->sws);
+    av_freep(&level->sws_ret);
+    level->nb_sws = 0;
+}
+
+static av_cold void uninit(AVFilterContext *ctx)
+{
+    ScaleLadderContext *s = ctx->priv;
+
+    for (int i = 0; i < s->nb_levels; i++) {
+        free_level(&s->levels[i]);
+        if (s->frames)
+            av_frame_free(&s->frames[i]);
+    }
+    av_freep(&s->levels);
+    av_freep(&s->frames);
+    s->nb_levels = 0;
+}
+
+static int query_formats(AVFilterContext *ctx)
+{
+    AVFilterFormats *formats = NULL;
+    const AVPixFmtDescriptor *desc = NULL;
+    int ret;
+
+    /* all the levels are scaled from one another,
+     * so they must share a single pixel format */
+    while ((desc = av_pix_fmt_desc_next(desc))) {
+        enum AVPixelFormat pix_fmt = av_pix_fmt_desc_get_id(desc);
+
+        if (desc->flags & (AV_PIX_FMT_FLAG_PAL | AV_PIX_FMT_FLAG_HWACCEL |
+                           AV_PIX_FMT_FLAG_BITSTREAM))
+            continue;
+        if (!sws_isSupportedInput(pix_fmt) || !sws_isSupportedOutput(pix_fmt))
+            continue;
+
+        ret = ff_add_format(&formats, pix_fmt);
+        if (ret < 0)
+            return ret;
+    }
+
+    return ff_set_common_formats(ctx, formats);
+}
+
+static int config_output(AVFilterLink *outlink)
+{
+    AVFilterContext *ctx = outlink->src;
+    ScaleLadderContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+    const int idx = FF_OUTLINK_IDX(outlink);
+    LadderLevel *level = &s->levels[idx];
+    const int src_w = idx ? s->levels[idx - 1].w : inlink->w;
+    const int src_h = idx ? s->levels[idx - 1].h : inlink->h;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(outlink->format);
+    int nb_sws, ret;
+
+    if (level->w > src_w || level->h > src_h) {
+        av_log(ctx, AV_LOG_ERROR, "Output size %dx%d is larger than "
+               "its source %dx%d\n", level->w, level->h, src_w, src_h);
+        return AVERROR(EINVAL);
+    }
+
+    outlink->w = level->w;
+    outlink->h = level->h;
+
+    if (inlink->sample_aspect_ratio.num)
+        outlink->sample_aspect_ratio = av_mul_q((AVRational){ outlink->h * inlink->w,
+                                                              outlink->w * inlink->h },
+                                                inlink->sample_aspect_ratio);
+    else
+        outlink->sample_aspect_ratio = inlink->sample_aspect_ratio;
+
+    free_level(level);
+
+    nb_sws = FFMAX(1, FFMIN(ff_filter_get_nb_threads(ctx), level->h / 16));
+
+    level->sws     = av_calloc(nb_sws, sizeof(*level->sws));
+    level->sws_ret = av_calloc(nb_sws, sizeof(*level->sws_ret));
+    if (!level->sws || !level->sws_ret)
+        return AVERROR(ENOMEM);
+
+    for (int i = 0; i < nb_sws; i++) {
+        struct SwsContext *sws = sws_alloc_context();
+        if (!sws)
+            return AVERROR(ENOMEM);
+        level->sws[level->nb_sws++] = sws;
+
+        av_opt_set_int(sws, "srcw",       src_w,           0);
+        av_opt_set_int(sws, "srch",       src_h,           0);
+        av_opt_set_int(sws, "src_format", inlink->format,  0);
+        av_opt_set_int(sws, "dstw",       level->w,        0);
+        av_opt_set_int(sws, "dsth",       level->h,        0);
+        av_opt_set_int(sws, "dst_format", outlink->format, 0);
+        av_opt_set_int(sws, "threads",    1,               0);
+        if (inlink->color_range != AVCOL_RANGE_UNSPECIFIED) {
+            av_opt_set_int(sws, "src_range", inlink->color_range == AVCOL_RANGE_JPEG, 0);
+            av_opt_set_int(sws, "dst_range", inlink->color_range == AVCOL_RANGE_JPEG, 0);
+        }
+
+        /* use MPEG chroma positions, like the scale filter */
+        if (desc->log2_chroma_h == 1) {
+            av_opt_set_int(sws, "src_v_chr_pos", 128, 0);
+            av_opt_set_int(sws, "dst_v_chr_pos", 128, 0);
+        }
+
+        if (s->flags_str && *s->flags_str) {
+            ret = av_opt_set(sws, "sws_flags", s->flags_str, 0);
+            if (ret < 0)
+                return ret;
+        }
+
+        ret = sws_init_context(sws, NULL, NULL);
+        if (ret < 0)
+            return ret;
+
+        /* slices must be aligned, fall back to a single job if the
+         * last one would not be */
+        if (level->h % sws_receive_slice_alignment(sws))
+            nb_sws = 1;
+    }
+
+    av_log(ctx, AV_LOG_VERBOSE, "output%d: %dx%d -> %dx%d fmt:%s jobs:%d\n",
+           idx, src_w, src_h, level->w, level->h,
+           av_get_pix_fmt_name(outlink->format), level->nb_sws);
+
+    return 0;
+}
+
+static int scale_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ThreadData *td = arg;
+    struct SwsContext *sws = td->level->sws[jobnr];
+    const int align  = sws_receive_slice_alignment(sws);
+    const int height = FFALIGN(FFMAX((td->out->height + nb_jobs - 1) / nb_jobs, 1),
+                               align);
+    const int start  = jobnr * height;
+    const int end    = FFMIN(start + height, td->out->height);
+    int ret;
+
+    if (end <= start)
+        return 0;
+
+    ret = sws_frame_start(sws, td->out, td->in);
+    if (ret < 0)
+        return ret;
+
+    ret = sws_send_slice(sws, 0, td->in->height);
+    if (ret >= 0)
+        ret = sws_receive_slice(sws, start, end - start);
+
+    sws_frame_end(sws);
+
+    return ret;
+}
+
+static int scale_ladder(AVFilterContext *ctx, const AVFrame *in)
+{
+    ScaleLadderContext *s = ctx->priv;
+
+    for (int i = 0; i < s->nb_levels; i++) {
+        AVFilterLink *outlink = ctx->outputs[i];
+        LadderLevel    *level = &s->levels[i];
+        const AVFrame    *src = i ? s->frames[i - 1] : in;
+        AVFrame          *out;
+        ThreadData td;
+        int ret;
+
+        out = ff_get_video_buffer(outlink, outlink->w, outlink->h);
+        if (!out)
+            return AVERROR(ENOMEM);
+        s->frames[i] = out;
+
+        ret = av_frame_copy_props(out, in);
+        if (ret < 0)
+            return ret;
+        out->sample_aspect_ratio = outlink->sample_aspect_ratio;
+
+        td.in    = src;
+        td.out   = out;
+        td.level = level;
+
+        ff_filter_execute(ctx, scale_slice, &td, level->sws_ret, level->nb_sws);
+        for (int j = 0; j < level->nb_sws; j++)
+            if (level->sws_ret[j] < 0)
+                return level->sws_ret[j];
+    }
+
+    return 0;
+}
+
+static int activate(AVFilterContext *ctx)
+{
+    ScaleLadderContext *s = ctx->priv;
+    AVFilterLink *inlink = ctx->inputs[0];
+    AVFrame *in;
+    int status, ret, nb_eofs = 0;
+    int64_t pts;
+
+    for (int i = 0; i < ctx->nb_outputs; i++)
+        nb_eofs += ff_outlink_get_status(ctx->outputs[i]) == AVERROR_EOF;
+
+    if (nb_eofs == ctx->nb_outputs) {
+        ff_inlink_set_status(inlink, AVERROR_EOF);
+        return 0;
+    }
+
+    ret = ff_inlink_consume_frame(inlink, &in);
+    if (ret < 0)
+        return ret;
+    if (ret > 0) {
+        ret = scale_ladder(ctx, in);
+        av_frame_free(&in);
+
+        /* all the levels are computed before any of them is sent, since
+         * the downstream filters may write into the frames they receive */
+        for (int i = 0; i < s->nb_levels; i++) {
+            AVFrame *out = s->frames[i];
+
+            s->frames[i] = NULL;
+            if (ret < 0 || ff_outlink_get_status(ctx->outputs[i])) {
+                av_frame_free(&out);
+                continue;
+            }
+
+            ret = ff_filter_frame(ctx->outputs[i], out);
+        }
+        if (ret < 0)
+            return ret;
+    }
+
+    if (ff_inlink_acknowledge_status(inlink, &status, &pts)) {
+        for (int i = 0; i < ctx->nb_outputs; i++) {
+            if (ff_outlink_get_status(ctx->outputs[i]))
+                continue;
+            ff_outlink_set_status(ctx->outputs[i], status, pts);
+        }
+        return 0;
+    }
+
+    for (int i = 0; i < ctx->nb_outputs; i++) {
+        if (ff_outlink_get_status(ctx->outputs[i]))
+            continue;
+
+        if (ff_outlink_frame_wanted(ctx->outputs[i])) {
+            ff_inlink_request_frame(inlink);
+            return 0;
+        }
+    }
+
+    return FFERROR_NOT_READY;
+}
+
+#define OFFSET(x) offsetof(ScaleLadderContext, x)
+#define FLAGS AV_OPT_FLAG_VIDEO_PARAM|AV_OPT_FLAG_FILTERING_PARAM
+
+static const AVOption scale_ladder_options[] = {
+    { "sizes", "'|'-separated list of output sizes, largest first", OFFSET(sizes_str), AV_OPT_TYPE_STRING, { .str = "hd720|640x360" }, .flags = FLAGS },
+    { "flags", "Flags to pass to libswscale", OFFSET(flags_str), AV_OPT_TYPE_STRING, { .str = "" }, .flags = FLAGS },
+    { NULL }
+};
+
+AVFILTER_DEFINE_CLASS(scale_ladder);
+
+static const AVFilterPad scale_ladder_inputs[] = {
+    {
+        .name = "default",
+        .type = AVMEDIA_TYPE_VIDEO,
+    },
+};
+
+const AVFilter ff_vf_scale_ladder = {
+    .name          = "scale_ladder",
+    .description   = NULL_IF_CONFIG_SMALL("Scale the input video to several cascaded sizes."),
+    .init          = init,
+    .uninit        = uninit,
+    .activate      = activate,
+    .priv_size     = sizeof(ScaleLadderContext),
+    .priv_class    = &scale_ladder_class,
+    FILTER_INPUTS(scale_ladder_inputs),
+    .outputs       = NULL,
+    FILTER_QUERY_FUNC(query_formats),
+    .flags         = AVFILTER_FLAG_DYNAMIC_OUTPUTS | AVFILTER_FLAG_SLICE_THREADS,
+};
@@ -143,4 +143,5 @@ const AVFilter ff_vf_vflip = {
     FILTER_INPUTS(avfilter_vf_vflip_inputs),
     FILTER_OUTPUTS(ff_video_default_filterpad),
     .flags       = AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC,
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
@@ -56,8 +56,8 @@ using namespace cv;
 std::unique_ptr<Yolov8Onnx> Yolov8OnnxModel;
 
 extern "C"{
-void vitis_filter_process_result(cv::Mat& image, const Yolov8OnnxResult& result) {
-    av_log(NULL, AV_LOG_INFO, "vitis filter: vitis_filter_process_result ------->\n");
+/* image is a band of rows of the frame, starting at row y0 */
+void vitis_filter_process_result(cv::Mat& image, const Yolov8OnnxResult& result, int y0) {
     for (auto& res : result.bboxes) {
         int label = res.label;
         auto& box = res.box;
@@ -65,16 +65,36 @@ void vitis_filter_process_result(cv::Mat& image, const Yolov8OnnxResult& result)
         /* std::cout << "result: " << label << "\t"  << classes[label] << "\t" << std::fixed << std::setprecision(2)
             << box[0] << "\t" << box[1] << "\t" << box[2] << "\t" << box[3] << "\t"
             << std::setprecision(4) << res.score << "\n"; */
-        cv::rectangle(image, cv::Point(box[0], box[1]), cv::Point(box[2], box[3]),
+        cv::rectangle(image, cv::Point(box[0], box[1] - y0), cv::Point(box[2], box[3] - y0),
                 cv::Scalar(b[label], g[label], r[label]), 3, 1, 0);
         cv::putText(image, classes[label] + " " + std::to_string(res.score),
-                        cv::Point(box[0] + 5, box[1] + 20), cv::FONT_HERSHEY_SIMPLEX, 0.5,
+                        cv::Point(box[0] + 5, box[1] + 20 - y0), cv::FONT_HERSHEY_SIMPLEX, 0.5,
                         cv::Scalar(b[label], g[label], r[label]), 2, 4);
                         // cv::Scalar(230, 216, 173), 2, 4);
     }
     return;
 }
 
+typedef struct VitisThreadData {
+    cv::Mat *image;
+    const Yolov8OnnxResult *result;
+} VitisThreadData;
+
+static int vitis_filter_process_result_slice(AVFilterContext *filter_ctx, void *arg,
+                                             int jobnr, int nb_jobs)
+{
+    VitisThreadData *td = (VitisThreadData *)arg;
+    const int rows = td->image->rows;
+    const int start = rows *  jobnr      / nb_jobs;
+    const int end   = rows * (jobnr + 1) / nb_jobs;
+
+    if (start < end) {
+        cv::Mat band = td->image->rowRange(start, end);
+        vitis_filter_process_result(band, *td->result, start);
+    }
+    return 0;
+}
+
 
 av_cold int vitis_filter_init(AVFilterContext *context)
 {
@@ -155,7 +175,10 @@ int vitis_filter_activate(AVFilterContext *filter_ctx)
         __TOC__(ONNX_RUN)
         
         __TIC__(SHOW)
-        vitis_filter_process_result(images[0], results[0]);
+        av_log(NULL, AV_LOG_INFO, "vitis filter: vitis_filter_process_result ------->\n");
+        VitisThreadData td = { &images[0], &results[0] };
+        ff_filter_execute(filter_ctx, vitis_filter_process_result_slice, &td, NULL,
+                          FFMAX(1, FFMIN(images[0].rows, ff_filter_get_nb_threads(filter_ctx))));
         //cv::imshow("yolov8-camera", images[0]);
         __TOC__(SHOW)
         av_log(NULL, AV_LOG_INFO, "vitis filter: cvmatToAvframe begin\n");
@@ -60,4 +60,6 @@ const AVFilter ff_vf_vitis_filter = {
     FILTER_PIXFMTS_ARRAY(pix_fmts),
     .priv_class    = &vitis_filter_class,
     .activate      = vitis_filter_activate,
+    .flags         = AVFILTER_FLAG_SLICE_THREADS,
+    .flags_internal = FF_FILTER_FLAG_RECONFIGURABLE,
 };
\ No newline at end of file
@@ -70,11 +70,19 @@ AVFrame *ff_default_get_video_buffer2(AVFilterLink *link, int w, int h, int alig
         return frame;
     }
 
-    if (!li->frame_pool) {
+    if (link->graph && fffiltergraph(link->graph)->frame_pool) {
+        frame = ff_graph_frame_pool_get_video(fffiltergraph(link->graph)->frame_pool,
+                                              w, h, link->format, align);
+        if (!frame)
+            return NULL;
+    } else if (!li->frame_pool) {
         li->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, w, h,
                                                   link->format, align);
         if (!li->frame_pool)
             return NULL;
+        if (link->graph)
+            ff_frame_pool_set_alloc_counter(li->frame_pool,
+                                            &fffiltergraph(link->graph)->link_pool_allocs);
     } else {
         if (ff_frame_pool_get_video_config(li->frame_pool,
                                            &pool_width, &pool_height,
@@ -90,12 +98,17 @@ AVFrame *ff_default_get_video_buffer2(AVFilterLink *link, int w, int h, int alig
                                                       link->format, align);
             if (!li->frame_pool)
                 return NULL;
+            if (link->graph)
+                ff_frame_pool_set_alloc_counter(li->frame_pool,
+                                                &fffiltergraph(link->graph)->link_pool_allocs);
         }
     }
 
-    frame = ff_frame_pool_get(li->frame_pool);
-    if (!frame)
-        return NULL;
+    if (!frame) {
+        frame = ff_frame_pool_get(li->frame_pool);
+        if (!frame)
+            return NULL;
+    }
 
     frame->sample_aspect_ratio = link->sample_aspect_ratio;
     frame->colorspace  = link->colorspace;
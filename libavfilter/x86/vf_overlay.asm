@@ -23,24 +23,92 @@
 
 %include "libavutil/x86/x86util.asm"
 
-SECTION_RODATA
+SECTION_RODATA 64
 
-pb_1:     times 16 db 1
-pw_128:   times  8 dw 128
-pw_255:   times  8 dw 255
-pw_257:   times  8 dw 257
+pb_1:     times 64 db 1
+pw_128:   times 32 dw 128
+pw_255:   times 32 dw 255
+pw_257:   times 32 dw 257
+pd_1:     times 16 dd 1
+pd_1023:  times 16 dd 1023
+pd_65535: times 16 dd 0xffff
 
 SECTION .text
 
-INIT_XMM sse4
-cglobal overlay_row_44, 5, 7, 6, 0, d, da, s, a, w, r, x
+; store the low bytes of the mmsize/2 words in m%1 to %2, clobbers m%3
+%macro STORE_WORDS_AS_BYTES 3
+%if mmsize == 64
+    vpmovwb          %2, m%1
+%elif mmsize == 32
+    vextracti128   xm%3, m%1, 1
+    packuswb       xm%1, xm%3
+    movu             %2, xm%1
+%else
+    packuswb        m%1, m%1
+    movq             %2, m%1
+%endif
+%endmacro
+
+; store the low words of the mmsize/4 dwords in m%1 to %2, clobbers m%3
+%macro STORE_DWORDS_AS_WORDS 3
+%if mmsize == 64
+    vpmovdw          %2, m%1
+%elif mmsize == 32
+    vextracti128   xm%3, m%1, 1
+    packusdw       xm%1, xm%3
+    movu             %2, xm%1
+%else
+    packusdw        m%1, m%1
+    movq             %2, m%1
+%endif
+%endmacro
+
+; m%1 = (m%2 * (255 - m%3) + m%1 * m%3) / 255 on words, rounded to nearest;
+; expects m3 = pw_255, m4 = pw_128, m5 = pw_257, clobbers m%3
+%macro BLEND_8 3
+    pmullw     m%1, m%3
+    pxor       m%3, m3
+    pmullw     m%2, m%3
+    paddw      m%1, m4
+    paddw      m%1, m%2
+    pmulhuw    m%1, m5
+%endmacro
+
+; m%1 = (m%2 * (1023 - m%3) + m%1 * m%3) / 1023 on dwords, rounded down;
+; expects m4 = pd_1023, m5 = pd_1, clobbers m%2, m%3 and m%4.
+; (x + (x >> 10) + 1) >> 10 is exact for all x <= 1023 * 1023
+%macro BLEND_10 4
+    psubd      m%4, m4, m%3
+    pslld      m%2, 16
+    pslld      m%4, 16
+    por        m%1, m%2
+    por        m%3, m%4
+    pmaddwd    m%1, m%3
+    psrld      m%2, m%1, 10
+    paddd      m%1, m5
+    paddd      m%1, m%2
+    psrld      m%1, 10
+%endmacro
+
+; set up xq, wq and rq so that the loop handles a multiple of %1 samples,
+; leaving out the last one if %2 is given,
+; jumps to .end if there are fewer than %1 of them
+%macro ROW_PROLOGUE 1-2
     xor          xq, xq
     movsxdifnidn wq, wd
+%if %0 > 1
+    sub          wq, 1
+%endif
     mov          rq, wq
-    and          rq, mmsize/2 - 1
-    cmp          wq, mmsize/2
+    and          rq, %1 - 1
+    cmp          wq, %1
     jl .end
     sub          wq, rq
+%endmacro
+
+%macro OVERLAY_ROW_8 0
+cglobal overlay_row_44, 5, 7, 6, 0, d, da, s, a, w, r, x
+    ROW_PROLOGUE mmsize/2
     mova         m3, [pw_255]
     mova         m4, [pw_128]
     mova         m5, [pw_257]
@@ -48,14 +116,8 @@ cglobal overlay_row_44, 5, 7, 6, 0, d, da, s, a, w, r, x
         pmovzxbw    m0, [sq+xq]
         pmovzxbw    m2, [aq+xq]
         pmovzxbw    m1, [dq+xq]
-        pmullw      m0, m2
-        pxor        m2, m3
-        pmullw      m1, m2
-        paddw       m0, m4
-        paddw       m0, m1
-        pmulhuw     m0, m5
-        packuswb    m0, m0
-        movq   [dq+xq], m0
+        BLEND_8      0, 1, 2
+        STORE_WORDS_AS_BYTES 0, [dq+xq], 1
         add         xq, mmsize/2
         cmp         xq, wq
         jl .loop
@@ -64,16 +126,8 @@ cglobal overlay_row_44, 5, 7, 6, 0, d, da, s, a, w, r, x
     mov    eax, xd
     RET
 
-INIT_XMM sse4
 cglobal overlay_row_22, 5, 7, 6, 0, d, da, s, a, w, r, x
-    xor          xq, xq
-    movsxdifnidn wq, wd
-    sub          wq, 1
-    mov          rq, wq
-    and          rq, mmsize/2 - 1
-    cmp          wq, mmsize/2
-    jl .end
-    sub          wq, rq
+    ROW_PROLOGUE mmsize/2, 1
     mova         m3, [pw_255]
     mova         m4, [pw_128]
     mova         m5, [pw_257]
@@ -86,14 +140,8 @@ cglobal overlay_row_22, 5, 7, 6, 0, d, da, s, a, w, r, x
         pavgw       m2, m1
         psrlw       m2, 8
         pmovzxbw    m1, [dq+xq]
-        pmullw      m0, m2
-        pxor        m2, m3
-        pmullw      m1, m2
-        paddw       m0, m4
-        paddw       m0, m1
-        pmulhuw     m0, m5
-        packuswb    m0, m0
-        movq   [dq+xq], m0
+        BLEND_8      0, 1, 2
+        STORE_WORDS_AS_BYTES 0, [dq+xq], 1
         add         xq, mmsize/2
         cmp         xq, wq
         jl .loop
@@ -102,18 +150,10 @@ cglobal overlay_row_22, 5, 7, 6, 0, d, da, s, a, w, r, x
     mov    eax, xd
     RET
 
-INIT_XMM sse4
 cglobal overlay_row_20, 6, 7, 7, 0, d, da, s, a, w, r, x
     mov         daq, aq
     add         daq, rmp
-    xor          xq, xq
-    movsxdifnidn wq, wd
-    sub          wq, 1
-    mov          rq, wq
-    and          rq, mmsize/2 - 1
-    cmp          wq, mmsize/2
-    jl .end
-    sub          wq, rq
+    ROW_PROLOGUE mmsize/2, 1
     mova         m3, [pw_255]
     mova         m4, [pw_128]
     mova         m5, [pw_257]
@@ -127,14 +167,8 @@ cglobal overlay_row_20, 6, 7, 7, 0, d, da, s, a, w, r, x
         paddw       m2, m1
         psrlw       m2, 2
         pmovzxbw    m1, [dq+xq]
-        pmullw      m0, m2
-        pxor        m2, m3
-        pmullw      m1, m2
-        paddw       m0, m4
-        paddw       m0, m1
-        pmulhuw     m0, m5
-        packuswb    m0, m0
-        movq   [dq+xq], m0
+        BLEND_8      0, 1, 2
+        STORE_WORDS_AS_BYTES 0, [dq+xq], 1
         add         xq, mmsize/2
         cmp         xq, wq
         jl .loop
@@ -142,3 +176,97 @@ cglobal overlay_row_20, 6, 7, 7, 0, d, da, s, a, w, r, x
     .end:
     mov    eax, xd
     RET
+
+; the destination samples are interleaved with the other chroma plane,
+; which is carried over in the high byte of each word
+cglobal overlay_row_20_nv12, 6, 7, 8, 0, d, da, s, a, w, r, x
+    mov         daq, aq
+    add         daq, rmp
+    ROW_PROLOGUE mmsize/2, 1
+    mova         m3, [pw_255]
+    mova         m4, [pw_128]
+    mova         m5, [pw_257]
+    mova         m6, [pb_1]
+    .loop:
+        pmovzxbw    m0, [sq+xq]
+        movu        m2, [aq+2*xq]
+        movu        m1, [daq+2*xq]
+        pmaddubsw   m2, m6
+        pmaddubsw   m1, m6
+        paddw       m2, m1
+        psrlw       m2, 2
+        movu        m7, [dq+2*xq]
+        pand        m1, m7, m3
+        BLEND_8      0, 1, 2
+        pandn       m7, m3, m7
+        por         m0, m7
+        movu [dq+2*xq], m0
+        add         xq, mmsize/2
+        cmp         xq, wq
+        jl .loop
+
+    .end:
+    mov    eax, xd
+    RET
+%endmacro
+
+%macro OVERLAY_ROW_10 0
+cglobal overlay_row_44_10, 5, 7, 6, 0, d, da, s, a, w, r, x
+    ROW_PROLOGUE mmsize/4
+    mova         m4, [pd_1023]
+    mova         m5, [pd_1]
+    .loop:
+        pmovzxwd    m0, [sq+2*xq]
+        pmovzxwd    m1, [dq+2*xq]
+        pmovzxwd    m2, [aq+2*xq]
+        BLEND_10     0, 1, 2, 3
+        STORE_DWORDS_AS_WORDS 0, [dq+2*xq], 1
+        add         xq, mmsize/4
+        cmp         xq, wq
+        jl .loop
+
+    .end:
+    mov    eax, xd
+    RET
+
+cglobal overlay_row_22_10, 5, 7, 7, 0, d, da, s, a, w, r, x
+    ROW_PROLOGUE mmsize/4, 1
+    mova         m4, [pd_1023]
+    mova         m5, [pd_1]
+    mova         m6, [pd_65535]
+    .loop:
+        pmovzxwd    m0, [sq+2*xq]
+        pmovzxwd    m1, [dq+2*xq]
+        movu        m2, [aq+4*xq]
+        psrld       m3, m2, 16
+        pand        m2, m6
+        paddd       m3, m2
+        psrld       m3, 1
+        paddd       m2, m3
+        psrld       m2, 1
+        BLEND_10     0, 1, 2, 3
+        STORE_DWORDS_AS_WORDS 0, [dq+2*xq], 1
+        add         xq, mmsize/4
+        cmp         xq, wq
+        jl .loop
+
+    .end:
+    mov    eax, xd
+    RET
+%endmacro
+
+INIT_XMM sse4
+OVERLAY_ROW_8
+OVERLAY_ROW_10
+
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+OVERLAY_ROW_8
+OVERLAY_ROW_10
+%endif
+
+%if HAVE_AVX512_EXTERNAL
+INIT_ZMM avx512
+OVERLAY_ROW_8
+OVERLAY_ROW_10
+%endif
@@ -496,6 +496,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
     int nb_out = s->out.ch_count;
 
     s->mix_any_f = NULL;
+    s->mix_n_1_f = NULL;
 
     if (!s->rematrix_custom) {
         int r = auto_matrix(s);
@@ -542,6 +543,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_float;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_float;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_float(s);
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_float;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_DBLP){
         s->native_matrix = av_calloc(nb_in * nb_out, sizeof(double));
         s->native_one    = av_mallocz(sizeof(double));
@@ -554,6 +556,7 @@ av_cold int swri_rematrix_init(SwrContext *s){
         s->mix_1_1_f = (mix_1_1_func_type*)copy_double;
         s->mix_2_1_f = (mix_2_1_func_type*)sum2_double;
         s->mix_any_f = (mix_any_func_type*)get_mix_any_func_double(s);
+        s->mix_n_1_f = (mix_n_1_func_type*)sumn_double;
     }else if(s->midbuf.fmt == AV_SAMPLE_FMT_S32P){
         s->native_one    = av_mallocz(sizeof(int));
         if (!s->native_one)
@@ -651,24 +654,17 @@ int swri_rematrix(SwrContext *s, AudioData *out, AudioData *in, int len, int mus
                 s->mix_2_1_f   (out->ch[out_i]+off, in->ch[in_i1]+off, in->ch[in_i2]+off, s->native_matrix, in->ch_count*out_i + in_i1, in->ch_count*out_i + in_i2, len-len1);
             break;}
         default:
-            if(s->int_sample_fmt == AV_SAMPLE_FMT_FLTP){
-                for(i=0; i<len; i++){
-                    float v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((float*)in->ch[in_i])[i] * s->matrix_flt[out_i][in_i];
-                    }
-                    ((float*)out->ch[out_i])[i]= v;
-                }
-            }else if(s->int_sample_fmt == AV_SAMPLE_FMT_DBLP){
-                for(i=0; i<len; i++){
-                    double v=0;
-                    for(j=0; j<s->matrix_ch[out_i][0]; j++){
-                        in_i= s->matrix_ch[out_i][1+j];
-                        v+= ((double*)in->ch[in_i])[i] * s->matrix[out_i][in_i];
-                    }
-                    ((double*)out->ch[out_i])[i]= v;
+            if(s->mix_n_1_f){
+                const uint8_t *ins[SWR_CH_MAX];
+                double coeffs[SWR_CH_MAX];
+                int nb_in = s->matrix_ch[out_i][0];
+
+                for(j=0; j<nb_in; j++){
+                    in_i= s->matrix_ch[out_i][1+j];
+                    ins[j]= in->ch[in_i];
+                    memcpy((uint8_t*)coeffs + j*out->bps, s->native_matrix + (in->ch_count*out_i + in_i)*out->bps, out->bps);
                 }
+                s->mix_n_1_f(out->ch[out_i], ins, coeffs, nb_in, len);
             }else{
                 for(i=0; i<len; i++){
                     int v=0;
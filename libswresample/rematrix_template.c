@@ -67,6 +67,19 @@ static void RENAME(copy)(SAMPLE *out, const SAMPLE *in, COEFF *coeffp, integer i
         out[i] = R(coeff*in[i]);
 }
 
+#if defined(TEMPLATE_REMATRIX_FLT) || defined(TEMPLATE_REMATRIX_DBL)
+static void RENAME(sumn)(SAMPLE *out, const SAMPLE **in, const COEFF *coeffp, integer nb_in, integer len){
+    int i, j;
+
+    for(i=0; i<len; i++) {
+        INTER v = 0;
+        for(j=0; j<nb_in; j++)
+            v += in[j][i] * (INTER)coeffp[j];
+        out[i] = R(v);
+    }
+}
+#endif
+
 static void RENAME(mix6to2)(SAMPLE **out, const SAMPLE **in, COEFF *coeffp, integer len){
     int i;
 
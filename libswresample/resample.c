@@ -28,8 +28,29 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/cpu.h"
+#include "libavutil/thread.h"
 #include "resample.h"
 
+/**
+ * A filter bank shared by all the resamplers built with the same
+ * build_filter() parameters.
+ */
+typedef struct FilterBankEntry {
+    struct FilterBankEntry *next;
+    uint8_t *bank;
+    int refcount;
+
+    enum AVSampleFormat format;
+    enum SwrFilterType filter_type;
+    double kaiser_beta;
+    double factor;
+    int filter_length;
+    int phase_count;
+} FilterBankEntry;
+
+static AVMutex filter_bank_lock = AV_MUTEX_INITIALIZER;
+static FilterBankEntry *filter_banks;
+
 /**
  * builds a polyphase filterbank.
  * @param factor resampling factor
@@ -173,11 +194,130 @@ fail:
     return ret;
 }
 
+static FilterBankEntry *find_filter_bank(const ResampleContext *c, double factor, int phase_count)
+{
+    FilterBankEntry *entry;
+
+    for (entry = filter_banks; entry; entry = entry->next) {
+        if (entry->format        == c->format        &&
+            entry->filter_type   == c->filter_type   &&
+            entry->kaiser_beta   == c->kaiser_beta   &&
+            entry->factor        == factor           &&
+            entry->filter_length == c->filter_length &&
+            entry->phase_count   == phase_count)
+            return entry;
+    }
+    return NULL;
+}
+
+/**
+ * Get a reference to the filter bank for the filter parameters of c, the
+ * given factor and phase_count, building it if no other resampler uses it.
+ * The bank must be released with filter_bank_unref() and not be written to.
+ */
+static int filter_bank_ref(ResampleContext *c, uint8_t **bank, double factor, int phase_count)
+{
+    FilterBankEntry *entry, *new_entry;
+    uint8_t *new_bank;
+    int ret;
+
+    ff_mutex_lock(&filter_bank_lock);
+    entry = find_filter_bank(c, factor, phase_count);
+    if (entry)
+        entry->refcount++;
+    ff_mutex_unlock(&filter_bank_lock);
+    if (entry) {
+        *bank = entry->bank;
+        return 0;
+    }
+
+    /* build outside of the lock, another thread may add the same bank meanwhile */
+    new_entry = av_mallocz(sizeof(*new_entry));
+    new_bank  = av_calloc(c->filter_alloc, (phase_count + 1) * c->felem_size);
+    if (!new_entry || !new_bank) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+    ret = build_filter(c, new_bank, factor, c->filter_length, c->filter_alloc,
+                       phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
+    if (ret < 0)
+        goto fail;
+    memcpy(new_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_bank, (c->filter_alloc-1)*c->felem_size);
+    memcpy(new_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
+
+    new_entry->bank          = new_bank;
+    new_entry->refcount      = 1;
+    new_entry->format        = c->format;
+    new_entry->filter_type   = c->filter_type;
+    new_entry->kaiser_beta   = c->kaiser_beta;
+    new_entry->factor        = factor;
+    new_entry->filter_length = c->filter_length;
+    new_entry->phase_count   = phase_count;
+
+    ff_mutex_lock(&filter_bank_lock);
+    entry = find_filter_bank(c, factor, phase_count);
+    if (entry) {
+        entry->refcount++;
+    } else {
+        new_entry->next = filter_banks;
+        filter_banks    = new_entry;
+        entry           = new_entry;
+    }
+    ff_mutex_unlock(&filter_bank_lock);
+
+    if (entry != new_entry) {
+        av_free(new_bank);
+        av_free(new_entry);
+    }
+    *bank = entry->bank;
+    return 0;
+fail:
+    av_free(new_bank);
+    av_free(new_entry);
+    return ret;
+}
+
+static void filter_bank_unref(uint8_t **bank)
+{
+    FilterBankEntry **entry, *unused = NULL;
+
+    if (!*bank)
+        return;
+
+    ff_mutex_lock(&filter_bank_lock);
+    for (entry = &filter_banks; (*entry)->bank != *bank; entry = &(*entry)->next)
+        av_assert0((*entry)->next);
+    if (!--(*entry)->refcount) {
+        unused = *entry;
+        *entry = unused->next;
+    }
+    ff_mutex_unlock(&filter_bank_lock);
+
+    if (unused) {
+        av_free(unused->bank);
+        av_free(unused);
+    }
+    *bank = NULL;
+}
+
+int swri_resample_nb_filter_banks(void)
+{
+    FilterBankEntry *entry;
+    int nb = 0;
+
+    ff_mutex_lock(&filter_bank_lock);
+    for (entry = filter_banks; entry; entry = entry->next)
+        nb++;
+    ff_mutex_unlock(&filter_bank_lock);
+
+    return nb;
+}
+
 static void resample_free(ResampleContext **cc){
     ResampleContext *c = *cc;
     if(!c)
         return;
-    av_freep(&c->filter_bank);
+    filter_bank_unref(&c->filter_bank);
     av_freep(cc);
 }
 
@@ -242,16 +382,11 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
         c->factor        = factor;
         c->filter_length = filter_length;
         c->filter_alloc  = FFALIGN(c->filter_length, 8);
-        c->filter_bank   = av_calloc(c->filter_alloc, (phase_count+1)*c->felem_size);
         c->filter_type   = filter_type;
         c->kaiser_beta   = kaiser_beta;
         c->phase_count_compensation = phase_count_compensation;
-        if (!c->filter_bank)
-            goto error;
-        if (build_filter(c, (void*)c->filter_bank, factor, c->filter_length, c->filter_alloc, phase_count, 1<<c->filter_shift, filter_type, kaiser_beta))
+        if (filter_bank_ref(c, &c->filter_bank, factor, phase_count) < 0)
             goto error;
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, c->filter_bank, (c->filter_alloc-1)*c->felem_size);
-        memcpy(c->filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, c->filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
     }
 
     c->compensation_distance= 0;
@@ -272,7 +407,7 @@ static ResampleContext *resample_init(ResampleContext *c, int out_rate, int in_r
 
     return c;
 error:
-    av_freep(&c->filter_bank);
+    filter_bank_unref(&c->filter_bank);
     av_free(c);
     return NULL;
 }
@@ -289,23 +424,14 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
 
     av_assert0(!c->frac && !c->dst_incr_mod);
 
-    new_filter_bank = av_calloc(c->filter_alloc, (phase_count + 1) * c->felem_size);
-    if (!new_filter_bank)
-        return AVERROR(ENOMEM);
-
-    ret = build_filter(c, new_filter_bank, c->factor, c->filter_length, c->filter_alloc,
-                       phase_count, 1 << c->filter_shift, c->filter_type, c->kaiser_beta);
-    if (ret < 0) {
-        av_freep(&new_filter_bank);
+    ret = filter_bank_ref(c, &new_filter_bank, c->factor, phase_count);
+    if (ret < 0)
         return ret;
-    }
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count+1)*c->felem_size, new_filter_bank, (c->filter_alloc-1)*c->felem_size);
-    memcpy(new_filter_bank + (c->filter_alloc*phase_count  )*c->felem_size, new_filter_bank + (c->filter_alloc - 1)*c->felem_size, c->felem_size);
 
     if (!av_reduce(&new_src_incr, &new_dst_incr, c->src_incr,
                    c->dst_incr * (int64_t)(phase_count/c->phase_count), INT32_MAX/2))
     {
-        av_freep(&new_filter_bank);
+        filter_bank_unref(&new_filter_bank);
         return AVERROR(EINVAL);
     }
 
@@ -320,7 +446,7 @@ static int rebuild_filter_bank_with_compensation(ResampleContext *c)
     c->dst_incr_mod   = c->dst_incr % c->src_incr;
     c->index         *= phase_count / c->phase_count;
     c->phase_count    = phase_count;
-    av_freep(&c->filter_bank);
+    filter_bank_unref(&c->filter_bank);
     c->filter_bank = new_filter_bank;
     return 0;
 }
@@ -60,6 +60,11 @@ typedef struct ResampleContext {
     } dsp;
 } ResampleContext;
 
+/**
+ * @return the number of filter banks currently shared between resamplers
+ */
+int swri_resample_nb_filter_banks(void);
+
 void swri_resample_dsp_init(ResampleContext *c);
 void swri_resample_dsp_x86_init(ResampleContext *c);
 void swri_resample_dsp_arm_init(ResampleContext *c);
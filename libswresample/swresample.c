@@ -21,6 +21,7 @@
 #include "libavutil/opt.h"
 #include "swresample_internal.h"
 #include "audioconvert.h"
+#include "resample.h"
 #include "libavutil/avassert.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/internal.h"
@@ -190,6 +191,58 @@ av_cold void swr_close(SwrContext *s){
     clear_context(s);
 }
 
+static int realloc_dither_noise(SwrContext *s, int count)
+{
+    int ch, ret;
+
+    if ((ret = swri_realloc_audio(&s->dither.noise, count)) <= 0)
+        return ret;
+    for (ch = 0; ch < s->dither.noise.ch_count; ch++)
+        if ((ret = swri_get_dither(s, s->dither.noise.ch[ch], s->dither.noise.count, (12345678913579ULL*ch + 3141592) % 2718281828U, s->dither.noise.fmt)) < 0)
+            return ret;
+    return 0;
+}
+
+/**
+ * Allocate every buffer swr_convert() can need for chunks of up to
+ * max_chunk_size input samples, so that no allocation happens afterwards.
+ */
+static av_cold int preallocate_buffers(SwrContext *s)
+{
+    int64_t in_max  = s->max_chunk_size;
+    int64_t out_max = in_max;
+    int ret;
+
+    if (s->resample) {
+        const ResampleContext *c = s->resample;
+        /* input left over from the previous call, the initial history
+         * and the flush reflection all fit in 3 filter lengths */
+        int64_t buffered = in_max + 3LL * c->filter_length + 16;
+
+        out_max = FFMAX(out_max, av_rescale_rnd(buffered + 2, s->out_sample_rate,
+                                                s->in_sample_rate, AV_ROUND_UP) + 4);
+        if (buffered > INT_MAX/2 || out_max > INT_MAX/2)
+            return AVERROR(EINVAL);
+        if ((ret = swri_realloc_audio(&s->in_buffer, buffered)) < 0)
+            return ret;
+    }
+
+    if ((ret = swri_realloc_audio(&s->postin, in_max)) < 0 ||
+        (ret = swri_realloc_audio(&s->midbuf, s->resample_first ? out_max : in_max)) < 0 ||
+        (ret = swri_realloc_audio(&s->preout, out_max)) < 0)
+        return ret;
+
+    if (s->dither.method) {
+        int dither_count = FFMAX(out_max, 1<<16);
+
+        if ((ret = swri_realloc_audio(&s->dither.temp, dither_count)) < 0 ||
+            (ret = realloc_dither_noise(s, dither_count)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
 av_cold int swr_init(struct SwrContext *s){
     int ret;
     char l1[1024], l2[1024];
@@ -389,6 +442,17 @@ av_cold int swr_init(struct SwrContext *s){
         }
     }
 
+    if (s->max_chunk_size) {
+        if (s->engine != SWR_ENGINE_SWR) {
+            av_log(s, AV_LOG_ERROR, "max_chunk_size is only supported by the swr resampler\n");
+            return AVERROR(EINVAL);
+        }
+        if (s->min_compensation < FLT_MAX/2) {
+            av_log(s, AV_LOG_ERROR, "max_chunk_size cannot be combined with timestamp compensation\n");
+            return AVERROR(EINVAL);
+        }
+    }
+
     if (s->out_sample_rate!=s->in_sample_rate || (s->flags & SWR_FLAG_RESAMPLE)){
         s->resample = s->resampler->init(s->resample, s->out_sample_rate, s->in_sample_rate, s->filter_size, s->phase_shift, s->linear_interp, s->cutoff, s->int_sample_fmt, s->filter_type, s->kaiser_beta, s->precision, s->cheby, s->exact_rational);
         if (!s->resample) {
@@ -511,6 +575,12 @@ av_assert0(s->out.ch_count);
             goto fail;
     }
 
+    if (s->max_chunk_size) {
+        ret = preallocate_buffers(s);
+        if (ret < 0)
+            goto fail;
+    }
+
     return 0;
 fail:
     swr_close(s);
@@ -601,6 +671,52 @@ static void buf_set(AudioData *out, AudioData *in, int count){
     }
 }
 
+/**
+ * Resample for the max_chunk_size mode: all input goes through the
+ * preallocated in_buffer and every output sample it allows is produced,
+ * so the amount of buffered input does not depend on the chunk sizes.
+ *
+ * @return number of samples output per channel
+ */
+static int resample_streaming(SwrContext *s, AudioData *out, int out_count,
+                              const AudioData *in_param, int in_count)
+{
+    AudioData in = *in_param, tmp = *in_param;
+    int ret, consumed, border, ch;
+
+    border = s->resampler->invert_initial_buffer(s->resample, &s->in_buffer,
+                 &in, in_count, &s->in_buffer_index, &s->in_buffer_count);
+    if (border == INT_MAX)
+        return 0;
+    else if (border < 0)
+        return border;
+    buf_set(&in, &in, border);
+    in_count -= border;
+
+    if (in_count) {
+        if ((ret = swri_realloc_audio(&s->in_buffer, s->in_buffer_index + s->in_buffer_count + in_count)) < 0)
+            return ret;
+        buf_set(&tmp, &s->in_buffer, s->in_buffer_index + s->in_buffer_count);
+        copy(&tmp, &in, in_count);
+        s->in_buffer_count += in_count;
+    }
+
+    buf_set(&tmp, &s->in_buffer, s->in_buffer_index);
+    ret = s->resampler->multiple_resample(s->resample, out, out_count, &tmp, s->in_buffer_count, &consumed);
+    s->in_buffer_count -= consumed;
+    s->in_buffer_index += consumed;
+
+    /* keep the remaining history at the start so the buffer never grows */
+    if (s->in_buffer_index) {
+        for (ch = 0; ch < s->in_buffer.ch_count; ch++)
+            memmove(s->in_buffer.ch[ch], s->in_buffer.ch[ch] + s->in_buffer_index * s->in_buffer.bps,
+                    s->in_buffer_count * s->in_buffer.bps);
+        s->in_buffer_index = 0;
+    }
+
+    return ret;
+}
+
 /**
  *
  * @return number of samples output per channel
@@ -616,6 +732,9 @@ static int resample(SwrContext *s, AudioData *out_param, int out_count,
     av_assert1(s->in_buffer.planar   == in_param->planar);
     av_assert1(s->in_buffer.fmt      == in_param->fmt);
 
+    if (s->max_chunk_size)
+        return resample_streaming(s, out_param, out_count, in_param, in_count);
+
     tmp=out=*out_param;
     in =  *in_param;
 
@@ -788,12 +907,8 @@ static int swr_convert_internal(struct SwrContext *s, AudioData *out, int out_co
                     return ret;
             }
 
-            if((ret=swri_realloc_audio(&s->dither.noise, dither_count))<0)
+            if((ret=realloc_dither_noise(s, dither_count))<0)
                 return ret;
-            if(ret)
-                for(ch=0; ch<s->dither.noise.ch_count; ch++)
-                    if((ret=swri_get_dither(s, s->dither.noise.ch[ch], s->dither.noise.count, (12345678913579ULL*ch + 3141592) % 2718281828U, s->dither.noise.fmt))<0)
-                        return ret;
             av_assert0(s->dither.noise.ch_count == preout->ch_count);
 
             if(s->dither.noise_pos + out_count > s->dither.noise.count)
@@ -846,6 +961,15 @@ int attribute_align_arg swr_convert(struct SwrContext *s,
         av_log(s, AV_LOG_ERROR, "Context has not been initialized\n");
         return AVERROR(EINVAL);
     }
+    if (s->max_chunk_size) {
+        if (!in_arg)
+            in_count = 0;
+        if (in_count > s->max_chunk_size) {
+            av_log(s, AV_LOG_ERROR, "%d input samples exceed max_chunk_size %d\n",
+                   in_count, s->max_chunk_size);
+            return AVERROR(EINVAL);
+        }
+    }
 #if defined(ASSERT_LEVEL) && ASSERT_LEVEL >1
     max_output = swr_get_out_samples(s, in_count);
 #endif
@@ -887,6 +1011,20 @@ int attribute_align_arg swr_convert(struct SwrContext *s,
 
     fill_audiodata(out, out_arg);
 
+    if (s->max_chunk_size) {
+        /* never hold output back, and never let the buffers grow; what does
+         * not fit when flushing is returned by the next flushing calls */
+        int needed = swr_get_out_samples(s, in_count);
+        if (needed < 0)
+            return needed;
+        if (out_count < needed && in_arg) {
+            av_log(s, AV_LOG_ERROR, "Output buffer of %d samples is smaller than the %d "
+                   "returned by swr_get_out_samples()\n", out_count, needed);
+            return AVERROR(EINVAL);
+        }
+        out_count = FFMIN(out_count, needed);
+    }
+
     if(s->resample){
         int ret = swr_convert_internal(s, out, out_count, in, in_count);
         if(ret>0 && !s->drop_output)
@@ -952,6 +1090,10 @@ int attribute_align_arg swr_convert(struct SwrContext *s,
 
 int swr_drop_output(struct SwrContext *s, int count){
     const uint8_t *tmp_arg[SWR_CH_MAX];
+
+    if (s->max_chunk_size)
+        return AVERROR(EINVAL);
+
     s->drop_output += count;
 
     if(s->drop_output <= 0)
@@ -968,6 +1110,9 @@ int swr_inject_silence(struct SwrContext *s, int count){
     if(count <= 0)
         return 0;
 
+    if (s->max_chunk_size)
+        return AVERROR(EINVAL);
+
 #define MAX_SILENCE_STEP 16384
     while (count > MAX_SILENCE_STEP) {
         if ((ret = swr_inject_silence(s, MAX_SILENCE_STEP)) < 0)
@@ -1026,6 +1171,8 @@ int swr_set_compensation(struct SwrContext *s, int sample_delta, int compensatio
         return AVERROR(EINVAL);
     if (!compensation_distance && sample_delta)
         return AVERROR(EINVAL);
+    if (s->max_chunk_size)
+        return AVERROR(EINVAL);
     if (!s->resample) {
         s->flags |= SWR_FLAG_RESAMPLE;
         ret = swr_init(s);
@@ -332,6 +332,12 @@ void swr_close(struct SwrContext *s);
  * upper bound on the required number of output samples for the given number of
  * input samples. Conversion will run directly without copying whenever possible.
  *
+ * When the max_chunk_size option is set, in_count must not exceed it and,
+ * except when flushing, out_count must be at least swr_get_out_samples(s, in_count).
+ * No memory is allocated then and every output sample the input allows is
+ * returned, so the delay reported by swr_get_delay() does not depend on how
+ * the input is split.
+ *
  * @param s         allocated Swr context, with parameters set
  * @param out       output buffers, only the first one need be set in case of packed audio
  * @param out_count amount of space available for output in samples per channel
@@ -39,6 +39,7 @@ typedef int integer;
 
 typedef void (mix_1_1_func_type)(void *out, const void *in, void *coeffp, integer index, integer len);
 typedef void (mix_2_1_func_type)(void *out, const void *in1, const void *in2, void *coeffp, integer index1, integer index2, integer len);
+typedef void (mix_n_1_func_type)(void *out, const uint8_t **in, const void *coeffp, integer nb_in, integer len);
 
 typedef void (mix_any_func_type)(uint8_t **out, const uint8_t **in1, void *coeffp, integer len);
 
@@ -145,6 +146,7 @@ struct SwrContext {
     float max_soft_compensation;                    ///< swr maximum soft compensation in seconds over soft_compensation_duration
     float async;                                    ///< swr simple 1 parameter async, similar to ffmpegs -async
     int64_t firstpts_in_samples;                    ///< swr first pts in samples
+    int max_chunk_size;                             ///< maximum input samples per swr_convert() call in low latency streaming mode, 0 if disabled
 
     int resample_first;                             ///< 1 if resampling must come first, 0 if rematrixing
     int rematrix;                                   ///< flag to indicate if rematrixing is needed (basically if input and output layouts mismatch)
@@ -187,6 +189,8 @@ struct SwrContext {
     mix_2_1_func_type *mix_2_1_f;
     mix_2_1_func_type *mix_2_1_simd;
 
+    mix_n_1_func_type *mix_n_1_f;                   ///< mixes the listed inputs into one output, float and double only
+
     mix_any_func_type *mix_any_f;
 
     /* TODO: callbacks for ASM optimizations */
@@ -0,0 +1,204 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Create and free resamplers from several threads at once, with the same
+ * and with different parameters, and check that the shared filter banks
+ * give the same output as resamplers created one at a time and are all
+ * freed with the last resampler using them.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+#include "libavutil/thread.h"
+
+#include "libswresample/resample.h"
+#include "libswresample/swresample.h"
+
+#define IN_RATE     48000
+#define IN_SAMPLES  4800
+#define NB_THREADS  4
+#define ITERATIONS  64
+
+static const struct {
+    int out_rate;
+    enum AVSampleFormat out_fmt;
+    int filter_size;
+} params[] = {
+    { 44100, AV_SAMPLE_FMT_S16, 32 },
+    { 44100, AV_SAMPLE_FMT_FLT, 32 },
+    { 16000, AV_SAMPLE_FMT_S16, 32 },
+    { 44100, AV_SAMPLE_FMT_S16, 16 },
+};
+
+#define NB_PARAMS FF_ARRAY_ELEMS(params)
+
+static int16_t input[IN_SAMPLES * 2];
+
+static struct {
+    uint8_t *data;
+    int nb_samples;
+} ref[NB_PARAMS];
+
+typedef struct ThreadContext {
+    int index;
+    int nb_mismatches;
+    int nb_errors;
+} ThreadContext;
+
+static SwrContext *alloc_context(int p)
+{
+    AVChannelLayout stereo = AV_CHANNEL_LAYOUT_STEREO;
+    SwrContext *s = NULL;
+
+    if (swr_alloc_set_opts2(&s, &stereo, params[p].out_fmt, params[p].out_rate,
+                            &stereo, AV_SAMPLE_FMT_S16, IN_RATE, 0, NULL) < 0)
+        return NULL;
+    av_opt_set_int(s, "filter_size", params[p].filter_size, 0);
+    if (swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+static int max_out_samples(int p)
+{
+    return (int64_t)IN_SAMPLES * params[p].out_rate / IN_RATE + 256;
+}
+
+static int out_sample_size(int p)
+{
+    return 2 * av_get_bytes_per_sample(params[p].out_fmt);
+}
+
+/* convert the whole input and flush, returns the number of output samples */
+static int convert(SwrContext *s, int p, uint8_t *out)
+{
+    const uint8_t *in = (const uint8_t *)input;
+    const int max_out = max_out_samples(p);
+    uint8_t *dst;
+    int count, flushed;
+
+    count = swr_convert(s, &out, max_out, &in, IN_SAMPLES);
+    if (count < 0)
+        return count;
+    dst     = out + count * out_sample_size(p);
+    flushed = swr_convert(s, &dst, max_out - count, NULL, 0);
+    return flushed < 0 ? flushed : count + flushed;
+}
+
+static void *thread_main(void *arg)
+{
+    ThreadContext *tc = arg;
+
+    for (int i = 0; i < ITERATIONS; i++) {
+        /* every thread cycles through all the parameters, so the same bank
+         * is requested and released concurrently by several threads */
+        const int p = (tc->index + i) % NB_PARAMS;
+        uint8_t *out = av_malloc(max_out_samples(p) * out_sample_size(p));
+        SwrContext *s = alloc_context(p);
+        int count;
+
+        if (!out || !s) {
+            tc->nb_errors++;
+        } else if ((count = convert(s, p, out)) < 0) {
+            tc->nb_errors++;
+        } else if (count != ref[p].nb_samples ||
+                   memcmp(out, ref[p].data, count * out_sample_size(p))) {
+            tc->nb_mismatches++;
+        }
+
+        swr_free(&s);
+        av_free(out);
+    }
+
+    return NULL;
+}
+
+int main(void)
+{
+    SwrContext *s[3] = { NULL };
+    ThreadContext tc[NB_THREADS] = { { 0 } };
+    pthread_t threads[NB_THREADS];
+    int ret = 0;
+
+    for (int i = 0; i < IN_SAMPLES; i++) {
+        input[2 * i]     = lrint(16000 * sin(2 * M_PI * 440 * i / IN_RATE));
+        input[2 * i + 1] = lrint(16000 * sin(2 * M_PI * 660 * i / IN_RATE));
+    }
+
+    /* references, with each resampler alone */
+    for (int p = 0; p < NB_PARAMS; p++) {
+        SwrContext *sc = alloc_context(p);
+
+        ref[p].data = av_malloc(max_out_samples(p) * out_sample_size(p));
+        if (!sc || !ref[p].data) {
+            fprintf(stderr, "init failed\n");
+            return 1;
+        }
+        ref[p].nb_samples = convert(sc, p, ref[p].data);
+        swr_free(&sc);
+        if (ref[p].nb_samples < 0) {
+            fprintf(stderr, "conversion failed\n");
+            return 1;
+        }
+    }
+    printf("banks after the reference runs: %d\n", swri_resample_nb_filter_banks());
+
+    /* same parameters share a bank, different ones do not */
+    s[0] = alloc_context(0);
+    s[1] = alloc_context(0);
+    printf("banks with 2 identical resamplers: %d\n", swri_resample_nb_filter_banks());
+    s[2] = alloc_context(2);
+    printf("banks with a third, different one: %d\n", swri_resample_nb_filter_banks());
+    swr_free(&s[0]);
+    printf("banks after freeing one of the identical ones: %d\n", swri_resample_nb_filter_banks());
+    swr_free(&s[1]);
+    swr_free(&s[2]);
+    printf("banks after freeing all: %d\n", swri_resample_nb_filter_banks());
+
+    for (int i = 0; i < NB_THREADS; i++) {
+        int err;
+
+        tc[i].index = i;
+        if ((err = pthread_create(&threads[i], NULL, thread_main, &tc[i]))) {
+            fprintf(stderr, "pthread_create failed: %s.\n", strerror(err));
+            return 1;
+        }
+    }
+    for (int i = 0; i < NB_THREADS; i++) {
+        pthread_join(threads[i], NULL);
+        printf("thread %d: %d resamplers, %d errors, %d mismatches\n", i,
+               ITERATIONS, tc[i].nb_errors, tc[i].nb_mismatches);
+        if (tc[i].nb_errors || tc[i].nb_mismatches)
+            ret = 1;
+    }
+    printf("banks after the threads ended: %d\n", swri_resample_nb_filter_banks());
+    if (swri_resample_nb_filter_banks())
+        ret = 1;
+
+    for (int p = 0; p < NB_PARAMS; p++)
+        av_free(ref[p].data);
+
+    return ret;
+}
@@ -0,0 +1,211 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check the max_chunk_size streaming mode: the output must match a single
+ * call of the default mode whatever the chunking, no allocation may happen
+ * once the context is initialized, and swr_get_delay() must not depend on
+ * the chunk sizes.
+ */
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/samplefmt.h"
+
+#include "libswresample/swresample.h"
+
+#define IN_SAMPLES  24000
+#define CHUNK       480
+
+static const struct {
+    int in_rate, out_rate;
+    enum AVSampleFormat in_fmt, out_fmt;
+    AVChannelLayout in_layout, out_layout;
+    const char *dither;
+} tests[] = {
+    { 44100, 48000, AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_FLT,
+      AV_CHANNEL_LAYOUT_STEREO,  AV_CHANNEL_LAYOUT_STEREO, "none" },
+    { 48000, 16000, AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_S16,
+      AV_CHANNEL_LAYOUT_MONO,    AV_CHANNEL_LAYOUT_MONO, "none" },
+    { 16000, 48000, AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_S16,
+      AV_CHANNEL_LAYOUT_STEREO,  AV_CHANNEL_LAYOUT_5POINT1, "none" },
+    { 48000, 48000, AV_SAMPLE_FMT_FLT, AV_SAMPLE_FMT_S16,
+      AV_CHANNEL_LAYOUT_5POINT1, AV_CHANNEL_LAYOUT_STEREO, "none" },
+    /* the dither noise position depends on the chunking, so the output
+     * is not compared for this one */
+    { 48000, 44100, AV_SAMPLE_FMT_S16, AV_SAMPLE_FMT_S16,
+      AV_CHANNEL_LAYOUT_STEREO,  AV_CHANNEL_LAYOUT_STEREO, "triangular" },
+};
+
+static void fill_input(uint8_t *buf, enum AVSampleFormat fmt, int channels, int rate)
+{
+    AVLFG lfg;
+
+    av_lfg_init(&lfg, 0x5eed);
+    for (int i = 0; i < IN_SAMPLES; i++) {
+        for (int ch = 0; ch < channels; ch++) {
+            double v = 0.4 * sin(2 * M_PI * (440 + 110 * ch) * i / rate) +
+                       0.1 * ((int)av_lfg_get(&lfg) / (double)INT_MAX);
+            if (fmt == AV_SAMPLE_FMT_S16)
+                ((int16_t *)buf)[i * channels + ch] = lrint(v * 32767);
+            else
+                ((float *)buf)[i * channels + ch] = v;
+        }
+    }
+}
+
+static SwrContext *alloc_context(int n, int max_chunk_size)
+{
+    SwrContext *s = NULL;
+
+    if (swr_alloc_set_opts2(&s, &tests[n].out_layout, tests[n].out_fmt, tests[n].out_rate,
+                            &tests[n].in_layout, tests[n].in_fmt, tests[n].in_rate, 0, NULL) < 0)
+        return NULL;
+    av_opt_set_int(s, "max_chunk_size", max_chunk_size, 0);
+    av_opt_set(s, "dither_method", tests[n].dither, 0);
+    if (swr_init(s) < 0)
+        swr_free(&s);
+    return s;
+}
+
+/* Convert the input in chunks, chunk <= 0 selects pseudo random sizes. */
+static int run_streaming(int n, const uint8_t *in, uint8_t *out, int chunk,
+                         int64_t *delay_min, int64_t *delay_max)
+{
+    const int in_size  = tests[n].in_layout.nb_channels  * av_get_bytes_per_sample(tests[n].in_fmt);
+    const int out_size = tests[n].out_layout.nb_channels * av_get_bytes_per_sample(tests[n].out_fmt);
+    const int64_t base = (int64_t)tests[n].in_rate * tests[n].out_rate;
+    SwrContext *s = alloc_context(n, CHUNK);
+    int64_t pos_in = 0, pos_out = 0, offset = 0;
+    AVLFG lfg;
+    int ret = 0;
+
+    if (!s)
+        return -1;
+
+    av_lfg_init(&lfg, 0xc0ffee);
+    *delay_min = INT64_MAX;
+    *delay_max = INT64_MIN;
+
+    /* any allocation from here on makes swr_convert() fail */
+    av_max_alloc(0);
+    for (;;) {
+        const uint8_t *src = in + pos_in * in_size;
+        uint8_t *dst = out + pos_out * out_size;
+        int count = chunk > 0 ? chunk : av_lfg_get(&lfg) % (CHUNK + 1);
+        int flush = pos_in >= IN_SAMPLES;
+
+        count = FFMIN(count, IN_SAMPLES - pos_in);
+        ret = swr_convert(s, &dst, swr_get_out_samples(s, count),
+                          flush ? NULL : &src, count);
+        if (ret < 0)
+            break;
+        pos_in  += count;
+        pos_out += ret;
+
+        if (!flush && pos_in > CHUNK) {
+            /* the reported delay must follow the input not output yet */
+            int64_t delay = swr_get_delay(s, base);
+            int64_t diff  = pos_in * tests[n].out_rate - pos_out * tests[n].in_rate - delay;
+
+            if (*delay_min == INT64_MAX)
+                offset = diff;
+            if (FFABS(diff - offset) > 1) {
+                ret = -1;
+                break;
+            }
+            *delay_min = FFMIN(*delay_min, delay);
+            *delay_max = FFMAX(*delay_max, delay);
+        }
+        if (flush && !ret)
+            break;
+    }
+    av_max_alloc(INT_MAX);
+
+    swr_free(&s);
+    return ret < 0 ? ret : pos_out;
+}
+
+int main(void)
+{
+    int ret = 0;
+
+    for (int n = 0; n < FF_ARRAY_ELEMS(tests); n++) {
+        const int in_ch  = tests[n].in_layout.nb_channels;
+        const int out_ch = tests[n].out_layout.nb_channels;
+        const int out_bps = av_get_bytes_per_sample(tests[n].out_fmt);
+        const int max_out = IN_SAMPLES * (int64_t)tests[n].out_rate / tests[n].in_rate + 1024;
+        uint8_t *in   = av_malloc(IN_SAMPLES * in_ch * av_get_bytes_per_sample(tests[n].in_fmt));
+        uint8_t *ref  = av_mallocz(max_out * out_ch * out_bps);
+        uint8_t *out  = av_mallocz(max_out * out_ch * out_bps);
+        SwrContext *s = alloc_context(n, 0);
+        const int compare = !strcmp(tests[n].dither, "none");
+        int ref_count = 0;
+
+        if (!in || !ref || !out || !s) {
+            fprintf(stderr, "test %d: init failed\n", n);
+            return 1;
+        }
+
+        fill_input(in, tests[n].in_fmt, in_ch, tests[n].in_rate);
+
+        ref_count = swr_convert(s, &ref, max_out, (const uint8_t **)&in, IN_SAMPLES);
+        if (ref_count >= 0) {
+            uint8_t *dst = ref + ref_count * out_ch * out_bps;
+            int flushed = swr_convert(s, &dst, max_out - ref_count, NULL, 0);
+            ref_count = flushed < 0 ? flushed : ref_count + flushed;
+        }
+        swr_free(&s);
+
+        printf("%d Hz %s %dch -> %d Hz %s %dch, dither %s:\n",
+               tests[n].in_rate,  av_get_sample_fmt_name(tests[n].in_fmt),  in_ch,
+               tests[n].out_rate, av_get_sample_fmt_name(tests[n].out_fmt), out_ch,
+               tests[n].dither);
+
+        for (int chunk = CHUNK; chunk >= 0; chunk -= CHUNK) {
+            int64_t delay_min, delay_max;
+            int count = run_streaming(n, in, out, chunk, &delay_min, &delay_max);
+
+            printf("  %s chunks: ", chunk ? "fixed" : "random");
+            if (count < 0) {
+                printf("conversion failed\n");
+                ret = 1;
+            } else if (compare && (count != ref_count ||
+                                   memcmp(out, ref, count * out_ch * out_bps))) {
+                printf("output mismatch (%d/%d samples)\n", count, ref_count);
+                ret = 1;
+            } else {
+                printf("%d samples, delay %.3f to %.3f ms\n", count,
+                       delay_min * 1000.0 / ((int64_t)tests[n].in_rate * tests[n].out_rate),
+                       delay_max * 1000.0 / ((int64_t)tests[n].in_rate * tests[n].out_rate));
+            }
+        }
+
+        av_free(in);
+        av_free(ref);
+        av_free(out);
+    }
+
+    return ret;
+}
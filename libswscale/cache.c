@@ -0,0 +1,271 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/**
+ * @file
+ * Cache of scaling contexts and of their shared filter banks.
+ */
+
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/mem.h"
+#include "libavutil/thread.h"
+
+#include "swscale.h"
+#include "swscale_internal.h"
+
+/* bounds on the memory held by a cache */
+#define MAX_FILTERS       256
+#define MAX_IDLE_CONTEXTS 64
+
+typedef struct FilterEntry {
+    SwsFilterKey key;
+    AVBufferRef *bank;
+    uint64_t     last_used;
+} FilterEntry;
+
+struct SwsContextCache {
+    AVMutex lock;
+
+    FilterEntry filters[MAX_FILTERS];
+    int      nb_filters;
+    uint64_t clock;
+
+    /* idle contexts, oldest first */
+    SwsContext *idle[MAX_IDLE_CONTEXTS];
+    int      nb_idle;
+};
+
+static void filter_bank_free(void *opaque, uint8_t *data)
+{
+    SwsFilterBank *bank = (SwsFilterBank *)data;
+
+    av_freep(&bank->filter);
+    av_freep(&bank->filter_pos);
+    av_free(bank);
+}
+
+AVBufferRef *ff_sws_filter_bank_alloc(int16_t *filter, int32_t *filter_pos,
+                                      int filter_size)
+{
+    SwsFilterBank *bank = av_mallocz(sizeof(*bank));
+    AVBufferRef *buf;
+
+    if (!bank) {
+        av_free(filter);
+        av_free(filter_pos);
+        return NULL;
+    }
+    bank->filter      = filter;
+    bank->filter_pos  = filter_pos;
+    bank->filter_size = filter_size;
+
+    buf = av_buffer_create((uint8_t *)bank, sizeof(*bank), filter_bank_free,
+                           NULL, AV_BUFFER_FLAG_READONLY);
+    if (!buf)
+        filter_bank_free(NULL, (uint8_t *)bank);
+    return buf;
+}
+
+static FilterEntry *find_filter(SwsContextCache *cache, const SwsFilterKey *key)
+{
+    for (int i = 0; i < cache->nb_filters; i++)
+        if (!memcmp(&cache->filters[i].key, key, sizeof(*key)))
+            return &cache->filters[i];
+    return NULL;
+}
+
+AVBufferRef *ff_sws_cache_get_filter(SwsContextCache *cache,
+                                     const SwsFilterKey *key)
+{
+    AVBufferRef *ret = NULL;
+    FilterEntry *entry;
+
+    ff_mutex_lock(&cache->lock);
+    entry = find_filter(cache, key);
+    if (entry) {
+        entry->last_used = ++cache->clock;
+        ret = av_buffer_ref(entry->bank);
+    }
+    ff_mutex_unlock(&cache->lock);
+
+    return ret;
+}
+
+int ff_sws_cache_add_filter(SwsContextCache *cache, const SwsFilterKey *key,
+                            AVBufferRef *bank)
+{
+    FilterEntry *entry;
+    int ret = 0;
+
+    ff_mutex_lock(&cache->lock);
+
+    /* another context may have computed the same filter meanwhile */
+    if (find_filter(cache, key))
+        goto end;
+
+    if (cache->nb_filters < MAX_FILTERS) {
+        entry = &cache->filters[cache->nb_filters++];
+    } else {
+        entry = &cache->filters[0];
+        for (int i = 1; i < cache->nb_filters; i++)
+            if (cache->filters[i].last_used < entry->last_used)
+                entry = &cache->filters[i];
+        av_buffer_unref(&entry->bank);
+    }
+
+    entry->bank = av_buffer_ref(bank);
+    if (!entry->bank) {
+        *entry = cache->filters[--cache->nb_filters];
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    entry->key       = *key;
+    entry->last_used = ++cache->clock;
+
+end:
+    ff_mutex_unlock(&cache->lock);
+    return ret;
+}
+
+SwsContextCache *sws_context_cache_alloc(void)
+{
+    SwsContextCache *cache = av_mallocz(sizeof(*cache));
+
+    if (!cache)
+        return NULL;
+
+    if (ff_mutex_init(&cache->lock, NULL)) {
+        av_free(cache);
+        return NULL;
+    }
+
+    return cache;
+}
+
+void sws_context_cache_free(SwsContextCache **pcache)
+{
+    SwsContextCache *cache = *pcache;
+
+    if (!cache)
+        return;
+
+    for (int i = 0; i < cache->nb_filters; i++)
+        av_buffer_unref(&cache->filters[i].bank);
+    for (int i = 0; i < cache->nb_idle; i++)
+        sws_freeContext(cache->idle[i]);
+
+    ff_mutex_destroy(&cache->lock);
+    av_freep(pcache);
+}
+
+SwsContext *ff_sws_context_cache_get(SwsContextCache *cache,
+                                     int srcW, int srcH, enum AVPixelFormat srcFormat,
+                                     int dstW, int dstH, enum AVPixelFormat dstFormat,
+                                     int flags, const double *param,
+                                     const float *norm_mean, const float *norm_scale)
+{
+    static const double default_param[2] = { SWS_PARAM_DEFAULT,
+                                             SWS_PARAM_DEFAULT };
+    SwsContext *c = NULL;
+
+    if (!param)
+        param = default_param;
+
+    ff_mutex_lock(&cache->lock);
+    for (int i = cache->nb_idle - 1; i >= 0; i--) {
+        SwsContext *idle = cache->idle[i];
+
+        if (idle->srcW      == srcW      &&
+            idle->srcH      == srcH      &&
+            idle->srcFormat == srcFormat &&
+            idle->dstW      == dstW      &&
+            idle->dstH      == dstH      &&
+            idle->dstFormat == dstFormat &&
+            idle->flags     == flags     &&
+            idle->param[0]  == param[0]  &&
+            idle->param[1]  == param[1]  &&
+            !memcmp(idle->norm_mean,  norm_mean,  sizeof(idle->norm_mean)) &&
+            !memcmp(idle->norm_scale, norm_scale, sizeof(idle->norm_scale))) {
+            c = idle;
+            memmove(&cache->idle[i], &cache->idle[i + 1],
+                    (cache->nb_idle - i - 1) * sizeof(*cache->idle));
+            cache->nb_idle--;
+            break;
+        }
+    }
+    ff_mutex_unlock(&cache->lock);
+
+    if (c)
+        return c;
+
+    c = sws_alloc_set_opts(srcW, srcH, srcFormat, dstW, dstH, dstFormat,
+                           flags, param);
+    if (!c)
+        return NULL;
+
+    memcpy(c->norm_mean,  norm_mean,  sizeof(c->norm_mean));
+    memcpy(c->norm_scale, norm_scale, sizeof(c->norm_scale));
+    c->filter_cache = cache;
+    if (sws_init_context(c, NULL, NULL) < 0) {
+        sws_freeContext(c);
+        return NULL;
+    }
+
+    return c;
+}
+
+SwsContext *sws_context_cache_get(SwsContextCache *cache,
+                                  int srcW, int srcH, enum AVPixelFormat srcFormat,
+                                  int dstW, int dstH, enum AVPixelFormat dstFormat,
+                                  int flags, const double *param)
+{
+    static const float norm_mean[3]  = { 0.0f, 0.0f, 0.0f };
+    static const float norm_scale[3] = { 1.0f, 1.0f, 1.0f };
+
+    return ff_sws_context_cache_get(cache, srcW, srcH, srcFormat,
+                                    dstW, dstH, dstFormat, flags, param,
+                                    norm_mean, norm_scale);
+}
+
+void sws_context_cache_release(SwsContextCache *cache, SwsContext **pctx)
+{
+    SwsContext *c = *pctx, *evicted = NULL;
+
+    if (!c)
+        return;
+    *pctx = NULL;
+
+    if (c->filter_cache != cache) {
+        sws_freeContext(c);
+        return;
+    }
+
+    ff_mutex_lock(&cache->lock);
+    if (cache->nb_idle == MAX_IDLE_CONTEXTS) {
+        evicted = cache->idle[0];
+        memmove(&cache->idle[0], &cache->idle[1],
+                (MAX_IDLE_CONTEXTS - 1) * sizeof(*cache->idle));
+        cache->nb_idle--;
+    }
+    cache->idle[cache->nb_idle++] = c;
+    ff_mutex_unlock(&cache->lock);
+
+    sws_freeContext(evicted);
+}
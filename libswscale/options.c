@@ -79,6 +79,13 @@ static const AVOption swscale_options[] = {
     { "uniform_color",   "blend onto a uniform color",    0,                 AV_OPT_TYPE_CONST,  { .i64  = SWS_ALPHA_BLEND_UNIFORM},INT_MIN, INT_MAX,     VE, .unit = "alphablend" },
     { "checkerboard",    "blend onto a checkerboard",     0,                 AV_OPT_TYPE_CONST,  { .i64  = SWS_ALPHA_BLEND_CHECKERBOARD},INT_MIN, INT_MAX,     VE, .unit = "alphablend" },
 
+    { "norm_mean_r",     "red mean subtracted from float RGB output",   OFFSET(norm_mean[0]),  AV_OPT_TYPE_FLOAT, { .dbl = 0 }, INT_MIN, INT_MAX, VE },
+    { "norm_mean_g",     "green mean subtracted from float RGB output", OFFSET(norm_mean[1]),  AV_OPT_TYPE_FLOAT, { .dbl = 0 }, INT_MIN, INT_MAX, VE },
+    { "norm_mean_b",     "blue mean subtracted from float RGB output",  OFFSET(norm_mean[2]),  AV_OPT_TYPE_FLOAT, { .dbl = 0 }, INT_MIN, INT_MAX, VE },
+    { "norm_scale_r",    "red scale of float RGB output",               OFFSET(norm_scale[0]), AV_OPT_TYPE_FLOAT, { .dbl = 1 }, INT_MIN, INT_MAX, VE },
+    { "norm_scale_g",    "green scale of float RGB output",             OFFSET(norm_scale[1]), AV_OPT_TYPE_FLOAT, { .dbl = 1 }, INT_MIN, INT_MAX, VE },
+    { "norm_scale_b",    "blue scale of float RGB output",              OFFSET(norm_scale[2]), AV_OPT_TYPE_FLOAT, { .dbl = 1 }, INT_MIN, INT_MAX, VE },
+
     { "threads",         "number of threads",             OFFSET(nb_threads),   AV_OPT_TYPE_INT, {.i64 = 1 }, 0, INT_MAX, VE, .unit = "threads" },
         { "auto",        NULL,                            0,                  AV_OPT_TYPE_CONST, {.i64 = 0 },    .flags = VE, .unit = "threads" },
 
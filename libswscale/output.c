@@ -2395,78 +2395,114 @@ yuv2gbrp16_full_X_c(SwsContext *c, const int16_t *lumFilter,
     }
 }
 
+static void rgb2float_c(float *dst, const int32_t *src, const float *coeffs,
+                        int width)
+{
+    for (int i = 0; i < width; i++)
+        dst[i] = (float)src[i] * coeffs[0] + coeffs[1];
+}
+
+static void rgb2half_c(uint16_t *dst, const int32_t *src, const float *coeffs,
+                       int width, const Float2HalfTables *tables)
+{
+    for (int i = 0; i < width; i++)
+        dst[i] = float2half(av_float2int((float)src[i] * coeffs[0] + coeffs[1]),
+                            tables);
+}
+
+#define FLOAT_OUTPUT_CHUNK 256
+
 static void
-yuv2gbrpf32_full_X_c(SwsContext *c, const int16_t *lumFilter,
-                    const int16_t **lumSrcx, int lumFilterSize,
-                    const int16_t *chrFilter, const int16_t **chrUSrcx,
-                    const int16_t **chrVSrcx, int chrFilterSize,
-                    const int16_t **alpSrcx, uint8_t **dest,
-                    int dstW, int y)
+yuv2gbrpf_full_X_c(SwsContext *c, const int16_t *lumFilter,
+                   const int16_t **lumSrcx, int lumFilterSize,
+                   const int16_t *chrFilter, const int16_t **chrUSrcx,
+                   const int16_t **chrVSrcx, int chrFilterSize,
+                   const int16_t **alpSrcx, uint8_t **dest,
+                   int dstW, int y)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->dstFormat);
-    int i;
     int hasAlpha = (desc->flags & AV_PIX_FMT_FLAG_ALPHA) && alpSrcx;
-    uint32_t **dest32 = (uint32_t**)dest;
+    int half = desc->comp[0].depth == 16;
+    int bswap = (!isBE(c->dstFormat)) != (!HAVE_BIGENDIAN);
     const int32_t **lumSrc  = (const int32_t**)lumSrcx;
     const int32_t **chrUSrc = (const int32_t**)chrUSrcx;
     const int32_t **chrVSrc = (const int32_t**)chrVSrcx;
     const int32_t **alpSrc  = (const int32_t**)alpSrcx;
-    static const float float_mult = 1.0f / 65535.0f;
+    /* samples in G, B, R, A order, like the planes */
+    LOCAL_ALIGNED_32(int32_t, rgba, [4], [FLOAT_OUTPUT_CHUNK]);
+    float coeffs[4][2];
+
+    /* map the [0, 65535] samples to (x / 65535 - mean) * scale */
+    for (int p = 0; p < 3; p++) {
+        int ch = (p + 1) % 3; /* R, G, B index of plane p */
+        coeffs[p][0] = c->norm_scale[ch] / 65535.0f;
+        coeffs[p][1] = -c->norm_mean[ch] * c->norm_scale[ch];
+    }
+    coeffs[3][0] = 1.0f / 65535.0f;
+    coeffs[3][1] = 0.0f;
 
-    for (i = 0; i < dstW; i++) {
-        int j;
-        int Y = -0x40000000;
-        int U = -(128 << 23);
-        int V = -(128 << 23);
-        int R, G, B, A;
+    for (int x = 0; x < dstW; x += FLOAT_OUTPUT_CHUNK) {
+        int w = FFMIN(FLOAT_OUTPUT_CHUNK, dstW - x);
 
-        for (j = 0; j < lumFilterSize; j++)
-            Y += lumSrc[j][i] * (unsigned)lumFilter[j];
+        for (int i = 0; i < w; i++) {
+            int j;
+            int Y = -0x40000000;
+            int U = -(128 << 23);
+            int V = -(128 << 23);
+            int R, G, B, A;
 
-        for (j = 0; j < chrFilterSize; j++) {
-            U += chrUSrc[j][i] * (unsigned)chrFilter[j];
-            V += chrVSrc[j][i] * (unsigned)chrFilter[j];
-        }
+            for (j = 0; j < lumFilterSize; j++)
+                Y += lumSrc[j][x + i] * (unsigned)lumFilter[j];
 
-        Y >>= 14;
-        Y += 0x10000;
-        U >>= 14;
-        V >>= 14;
+            for (j = 0; j < chrFilterSize; j++) {
+                U += chrUSrc[j][x + i] * (unsigned)chrFilter[j];
+                V += chrVSrc[j][x + i] * (unsigned)chrFilter[j];
+            }
 
-        if (hasAlpha) {
-            A = -0x40000000;
+            Y >>= 14;
+            Y += 0x10000;
+            U >>= 14;
+            V >>= 14;
 
-            for (j = 0; j < lumFilterSize; j++)
-                A += alpSrc[j][i] * (unsigned)lumFilter[j];
+            if (hasAlpha) {
+                A = -0x40000000;
 
-            A >>= 1;
-            A += 0x20002000;
+                for (j = 0; j < lumFilterSize; j++)
+                    A += alpSrc[j][x + i] * (unsigned)lumFilter[j];
+
+                A >>= 1;
+                A += 0x20002000;
+                rgba[3][i] = av_clip_uintp2(A, 30) >> 14;
+            }
+
+            Y -= c->yuv2rgb_y_offset;
+            Y *= c->yuv2rgb_y_coeff;
+            Y += (1 << 13) - (1 << 29);
+            R = V * c->yuv2rgb_v2r_coeff;
+            G = V * c->yuv2rgb_v2g_coeff + U * c->yuv2rgb_u2g_coeff;
+            B =                            U * c->yuv2rgb_u2b_coeff;
+
+            rgba[0][i] = av_clip_uintp2(((Y + G) >> 14) + (1<<15), 16);
+            rgba[1][i] = av_clip_uintp2(((Y + B) >> 14) + (1<<15), 16);
+            rgba[2][i] = av_clip_uintp2(((Y + R) >> 14) + (1<<15), 16);
         }
 
-        Y -= c->yuv2rgb_y_offset;
-        Y *= c->yuv2rgb_y_coeff;
-        Y += (1 << 13) - (1 << 29);
-        R = V * c->yuv2rgb_v2r_coeff;
-        G = V * c->yuv2rgb_v2g_coeff + U * c->yuv2rgb_u2g_coeff;
-        B =                            U * c->yuv2rgb_u2b_coeff;
+        for (int p = 0; p < 3 + hasAlpha; p++) {
+            if (half) {
+                uint16_t *dst = (uint16_t *)dest[p] + x;
 
-        R = av_clip_uintp2(((Y + R) >> 14) + (1<<15), 16);
-        G = av_clip_uintp2(((Y + G) >> 14) + (1<<15), 16);
-        B = av_clip_uintp2(((Y + B) >> 14) + (1<<15), 16);
+                c->rgb2half(dst, rgba[p], coeffs[p], w, c->f2h_tables);
+                if (bswap)
+                    for (int i = 0; i < w; i++)
+                        dst[i] = av_bswap16(dst[i]);
+            } else {
+                float *dst = (float *)dest[p] + x;
 
-        dest32[0][i] = av_float2int(float_mult * (float)G);
-        dest32[1][i] = av_float2int(float_mult * (float)B);
-        dest32[2][i] = av_float2int(float_mult * (float)R);
-        if (hasAlpha)
-            dest32[3][i] = av_float2int(float_mult * (float)(av_clip_uintp2(A, 30) >> 14));
-    }
-    if ((!isBE(c->dstFormat)) != (!HAVE_BIGENDIAN)) {
-        for (i = 0; i < dstW; i++) {
-            dest32[0][i] = av_bswap32(dest32[0][i]);
-            dest32[1][i] = av_bswap32(dest32[1][i]);
-            dest32[2][i] = av_bswap32(dest32[2][i]);
-            if (hasAlpha)
-                dest32[3][i] = av_bswap32(dest32[3][i]);
+                c->rgb2float(dst, rgba[p], coeffs[p], w);
+                if (bswap)
+                    for (int i = 0; i < w; i++)
+                        AV_WN32A(&dst[i], av_bswap32(AV_RN32A(&dst[i])));
+            }
         }
     }
 }
@@ -3057,11 +3093,15 @@ av_cold void ff_sws_init_output_funcs(SwsContext *c,
         case AV_PIX_FMT_GBRAP16LE:
             *yuv2anyX = yuv2gbrp16_full_X_c;
             break;
+        case AV_PIX_FMT_GBRPF16BE:
+        case AV_PIX_FMT_GBRPF16LE:
         case AV_PIX_FMT_GBRPF32BE:
         case AV_PIX_FMT_GBRPF32LE:
         case AV_PIX_FMT_GBRAPF32BE:
         case AV_PIX_FMT_GBRAPF32LE:
-            *yuv2anyX = yuv2gbrpf32_full_X_c;
+            *yuv2anyX = yuv2gbrpf_full_X_c;
+            c->rgb2float = rgb2float_c;
+            c->rgb2half  = rgb2half_c;
             break;
         }
         if (!*yuv2packedX && !*yuv2anyX)
@@ -1129,6 +1129,31 @@ unsigned int sws_receive_slice_alignment(const struct SwsContext *c)
     return c->dst_slice_align;
 }
 
+static void slice_job(void *priv, int jobnr, int nb_jobs)
+{
+    /* every job runs at most once, so it can own a slice context */
+    ff_sws_slice_worker(priv, jobnr, jobnr, nb_jobs, nb_jobs);
+}
+
+/* run nb_jobs slice jobs, on the caller's executor if there is one */
+static int execute_slices(SwsContext *c, int nb_jobs)
+{
+    int ret = 0;
+
+    if (c->execute)
+        ret = c->execute(c->execute_opaque, slice_job, c, nb_jobs);
+    else
+        avpriv_slicethread_execute(c->slicethread, nb_jobs, 0);
+
+    for (int i = 0; i < c->nb_threads && ret >= 0; i++)
+        if (c->slice_err[i] < 0)
+            ret = c->slice_err[i];
+
+    memset(c->slice_err, 0, c->nb_threads * sizeof(*c->slice_err));
+
+    return ret;
+}
+
 int sws_receive_slice(struct SwsContext *c, unsigned int slice_start,
                       unsigned int slice_height)
 {
@@ -1149,29 +1174,19 @@ int sws_receive_slice(struct SwsContext *c, unsigned int slice_start,
         return AVERROR(EINVAL);
     }
 
-    if (c->slicethread) {
+    if (c->nb_slice_ctx) {
         int nb_jobs = c->slice_ctx[0]->dither == SWS_DITHER_ED ? 1 : c->nb_slice_ctx;
-        int ret = 0;
 
         c->dst_slice_start  = slice_start;
         c->dst_slice_height = slice_height;
 
-        avpriv_slicethread_execute(c->slicethread, nb_jobs, 0);
-
-        for (int i = 0; i < c->nb_slice_ctx; i++) {
-            if (c->slice_err[i] < 0) {
-                ret = c->slice_err[i];
-                break;
-            }
-        }
-
-        memset(c->slice_err, 0, c->nb_slice_ctx * sizeof(*c->slice_err));
-
-        return ret;
+        return execute_slices(c, nb_jobs);
     }
 
     for (int i = 0; i < FF_ARRAY_ELEMS(dst); i++) {
-        ptrdiff_t offset = c->frame_dst->linesize[i] * (slice_start >> c->chrDstVSubSample);
+        const int vshift = (i == 1 || i == 2) ? c->chrDstVSubSample : 0;
+        const ptrdiff_t offset = c->frame_dst->linesize[i] *
+            (ptrdiff_t)(slice_start >> vshift);
         dst[i] = FF_PTR_ADD(c->frame_dst->data[i], offset);
     }
 
@@ -1214,18 +1229,149 @@ int attribute_align_arg sws_scale(struct SwsContext *c,
                           dst, dstStride, 0, c->dstH);
 }
 
+static int scale_roi(SwsContext *c, const SwsROI *roi)
+{
+    /* the colorspace details are only kept up to date in the slice contexts */
+    const SwsContext *ref = c->nb_slice_ctx ? c->slice_ctx[0] : c;
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    const AVFrame *frame = c->roi_src;
+    const int x = roi->x & ~((1 << desc->log2_chroma_w) - 1);
+    const int y = roi->y & ~((1 << desc->log2_chroma_h) - 1);
+    const uint8_t *src[4] = { NULL };
+    int step[4] = { 0 };
+    SwsContext *roi_ctx;
+    int ret;
+
+    roi_ctx = ff_sws_context_cache_get(c->roi_cache, roi->w, roi->h, c->srcFormat,
+                                       c->dstW, c->dstH, c->dstFormat,
+                                       c->flags, c->param,
+                                       c->norm_mean, c->norm_scale);
+    if (!roi_ctx)
+        return AVERROR(ENOMEM);
+
+    if (memcmp(roi_ctx->srcColorspaceTable, ref->srcColorspaceTable,
+               sizeof(ref->srcColorspaceTable)) ||
+        memcmp(roi_ctx->dstColorspaceTable, ref->dstColorspaceTable,
+               sizeof(ref->dstColorspaceTable)) ||
+        roi_ctx->srcRange   != ref->srcRange   ||
+        roi_ctx->dstRange   != ref->dstRange   ||
+        roi_ctx->brightness != ref->brightness ||
+        roi_ctx->contrast   != ref->contrast   ||
+        roi_ctx->saturation != ref->saturation) {
+        ret = sws_setColorspaceDetails(roi_ctx, ref->srcColorspaceTable, ref->srcRange,
+                                       ref->dstColorspaceTable, ref->dstRange,
+                                       ref->brightness, ref->contrast, ref->saturation);
+        if (ret < 0) {
+            sws_freeContext(roi_ctx);
+            return ret;
+        }
+    }
+
+    /* bytes per pixel of each plane, which is the smallest component step
+     * for packed subsampled formats like YUYV */
+    for (int i = 0; i < desc->nb_components; i++) {
+        const AVComponentDescriptor *comp = &desc->comp[i];
+        if (!step[comp->plane] || comp->step < step[comp->plane])
+            step[comp->plane] = comp->step;
+    }
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(src) && frame->data[i]; i++) {
+        const int hshift = (i == 1 || i == 2) ? desc->log2_chroma_w : 0;
+        const int vshift = (i == 1 || i == 2) ? desc->log2_chroma_h : 0;
+
+        if (i == 1 && (desc->flags & AV_PIX_FMT_FLAG_PAL))
+            src[i] = frame->data[i];
+        else
+            src[i] = frame->data[i] + (y >> vshift) * (ptrdiff_t)frame->linesize[i] +
+                     (x >> hshift) * step[i];
+    }
+
+    ret = sws_scale(roi_ctx, src, frame->linesize, 0, roi->h,
+                    roi->dst, roi->dst_stride);
+
+    sws_context_cache_release(c->roi_cache, &roi_ctx);
+    return FFMIN(ret, 0);
+}
+
+int sws_scale_rois(struct SwsContext *c, const AVFrame *src,
+                   const SwsROI *rois, int nb_rois)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(c->srcFormat);
+    int ret = 0;
+
+    if (src->width != c->srcW || src->height != c->srcH) {
+        av_log(c, AV_LOG_ERROR, "Source frame size %dx%d does not match the "
+               "configured %dx%d\n", src->width, src->height, c->srcW, c->srcH);
+        return AVERROR(EINVAL);
+    }
+    if (desc->flags & (AV_PIX_FMT_FLAG_BITSTREAM | AV_PIX_FMT_FLAG_HWACCEL)) {
+        av_log(c, AV_LOG_ERROR, "Regions of %s images are not supported\n",
+               desc->name);
+        return AVERROR(ENOSYS);
+    }
+
+    for (int i = 0; i < nb_rois; i++) {
+        const SwsROI *roi = &rois[i];
+
+        if (roi->x < 0 || roi->y < 0 || roi->w <= 0 || roi->h <= 0 ||
+            roi->x > c->srcW - roi->w || roi->y > c->srcH - roi->h) {
+            av_log(c, AV_LOG_ERROR, "Invalid region %d: %dx%d at %d,%d\n",
+                   i, roi->w, roi->h, roi->x, roi->y);
+            return AVERROR(EINVAL);
+        }
+    }
+
+    if (!nb_rois)
+        return 0;
+
+    if (!c->roi_cache) {
+        c->roi_cache = sws_context_cache_alloc();
+        if (!c->roi_cache)
+            return AVERROR(ENOMEM);
+    }
+
+    c->roi_src = src;
+    c->rois    = rois;
+    c->nb_rois = nb_rois;
+
+    if (c->nb_slice_ctx) {
+        ret = execute_slices(c, FFMIN(nb_rois, c->nb_threads));
+    } else {
+        for (int i = 0; i < nb_rois && ret >= 0; i++)
+            ret = scale_roi(c, &rois[i]);
+    }
+
+    c->roi_src = NULL;
+    c->rois    = NULL;
+    c->nb_rois = 0;
+
+    return ret;
+}
+
 void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
                          int nb_jobs, int nb_threads)
 {
     SwsContext *parent = priv;
-    SwsContext      *c = parent->slice_ctx[threadnr];
-
-    const int slice_height = FFALIGN(FFMAX((parent->dst_slice_height + nb_jobs - 1) / nb_jobs, 1),
-                                     c->dst_slice_align);
-    const int slice_start  = jobnr * slice_height;
-    const int slice_end    = FFMIN((jobnr + 1) * slice_height, parent->dst_slice_height);
+    SwsContext *c;
+    int slice_height, slice_start, slice_end;
     int err = 0;
 
+    /* regions use their own contexts, there may be no slice context for
+     * this thread when error-diffusion dither is in use */
+    if (parent->rois) {
+        for (int i = jobnr; i < parent->nb_rois && err >= 0; i += nb_jobs)
+            err = scale_roi(parent, &parent->rois[i]);
+        if (err < 0)
+            parent->slice_err[threadnr] = err;
+        return;
+    }
+
+    c = parent->slice_ctx[threadnr];
+    slice_height = FFALIGN(FFMAX((parent->dst_slice_height + nb_jobs - 1) / nb_jobs, 1),
+                           c->dst_slice_align);
+    slice_start  = jobnr * slice_height;
+    slice_end    = FFMIN((jobnr + 1) * slice_height, parent->dst_slice_height);
+
     if (slice_end > slice_start) {
         uint8_t *dst[4] = { NULL };
 
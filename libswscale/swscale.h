@@ -154,6 +154,30 @@ int sws_isSupportedEndiannessConversion(enum AVPixelFormat pix_fmt);
  */
 struct SwsContext *sws_alloc_context(void);
 
+/**
+ * Callback running func(arg, jobnr, nb_jobs) for every jobnr in
+ * [0, nb_jobs), possibly in parallel, and returning once all jobs are done.
+ *
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+typedef int (*SwsExecuteFunc)(void *opaque,
+                              void (*func)(void *arg, int jobnr, int nb_jobs),
+                              void *arg, int nb_jobs);
+
+/**
+ * Make the context run its slice jobs through execute instead of spawning
+ * its own worker threads, e.g. to share the thread pool of the caller.
+ *
+ * Must be called before sws_init_context(). The "threads" option then sets
+ * the maximal number of jobs, which execute may run in any order and on
+ * any number of threads.
+ *
+ * @param c       The scaling context
+ * @param execute The executor, or NULL to restore the internal threads
+ * @param opaque  Passed as is to execute
+ */
+void sws_set_executor(struct SwsContext *c, SwsExecuteFunc execute, void *opaque);
+
 /**
  * Initialize the swscaler context sws_context.
  *
@@ -243,6 +267,41 @@ int sws_scale(struct SwsContext *c, const uint8_t *const srcSlice[],
  */
 int sws_scale_frame(struct SwsContext *c, AVFrame *dst, const AVFrame *src);
 
+/**
+ * A region of a source image to be scaled by sws_scale_rois(), and the
+ * destination it is written to.
+ */
+typedef struct SwsROI {
+    /**
+     * top left corner of the region in the source, in luma pixels, rounded
+     * down to a multiple of the chroma subsampling
+     */
+    int x, y;
+    int w, h;           ///< size of the region in the source, in luma pixels
+    uint8_t *dst[4];    ///< destination planes
+    int dst_stride[4];  ///< destination strides
+} SwsROI;
+
+/**
+ * Scale several regions of one source image, e.g. the objects detected in a
+ * frame, each to a destination of the size and format configured in c.
+ *
+ * The source width, height and format configured in c are those of the
+ * whole source image; the scaling flags, parameters and colorspace details
+ * of c apply to every region. The regions are distributed across the
+ * threads of c. The contexts used for the individual regions are kept in c
+ * and reused by later calls for regions of the same size.
+ *
+ * @param c       The scaling context
+ * @param src     The source frame
+ * @param rois    The regions to scale, with their destinations
+ * @param nb_rois The number of regions
+ *
+ * @return 0 on success, a negative AVERROR code on failure
+ */
+int sws_scale_rois(struct SwsContext *c, const AVFrame *src,
+                   const SwsROI *rois, int nb_rois);
+
 /**
  * Initialize the scaling process for a given pair of source/destination frames.
  * Must be called before any calls to sws_send_slice() and sws_receive_slice().
@@ -397,6 +456,61 @@ struct SwsContext *sws_getCachedContext(struct SwsContext *context,
                                         int flags, SwsFilter *srcFilter,
                                         SwsFilter *dstFilter, const double *param);
 
+/**
+ * A cache of scaling contexts and of the filter coefficients they use.
+ *
+ * Contexts obtained from the same cache share their filter coefficients
+ * whenever the geometry, flags and CPU features match, so that setting up a
+ * context for an already seen geometry does not recompute them. Contexts
+ * handed back with sws_context_cache_release() are kept for reuse by later
+ * sws_context_cache_get() calls with the same parameters.
+ *
+ * All functions operating on a cache are thread-safe. This is useful when
+ * scaling many small regions, e.g. detection bounding boxes, where setting
+ * up the context would otherwise dominate the cost of the conversion.
+ */
+typedef struct SwsContextCache SwsContextCache;
+
+/**
+ * Allocate an empty context cache.
+ *
+ * @return the new cache, or NULL on allocation failure
+ */
+SwsContextCache *sws_context_cache_alloc(void);
+
+/**
+ * Free a context cache and all the idle contexts it holds, and set *cache
+ * to NULL. All the contexts obtained from the cache must have been released
+ * or freed before.
+ */
+void sws_context_cache_free(SwsContextCache **cache);
+
+/**
+ * Get an initialized scaling context for the given parameters, reusing an
+ * idle context from the cache if one matches, or creating a new one sharing
+ * the cached filter coefficients otherwise.
+ *
+ * The parameters have the same meaning as for sws_getContext(). The
+ * returned context is owned by the caller until it is passed to
+ * sws_context_cache_release() or sws_freeContext().
+ *
+ * @return the context, or NULL on error
+ */
+struct SwsContext *sws_context_cache_get(SwsContextCache *cache,
+                                         int srcW, int srcH, enum AVPixelFormat srcFormat,
+                                         int dstW, int dstH, enum AVPixelFormat dstFormat,
+                                         int flags, const double *param);
+
+/**
+ * Hand a context obtained from sws_context_cache_get() back to the cache for
+ * later reuse, and set *ctx to NULL. The context may be freed instead if the
+ * cache is full.
+ *
+ * Contexts whose options or colorspace details were changed after they were
+ * obtained must be freed with sws_freeContext() instead.
+ */
+void sws_context_cache_release(SwsContextCache *cache, struct SwsContext **ctx);
+
 /**
  * Convert an 8-bit paletted frame into a frame with a color depth of 32 bits.
  *
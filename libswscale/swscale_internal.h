@@ -26,6 +26,7 @@
 #include "config.h"
 
 #include "libavutil/avassert.h"
+#include "libavutil/buffer.h"
 #include "libavutil/common.h"
 #include "libavutil/frame.h"
 #include "libavutil/intreadwrite.h"
@@ -35,6 +36,7 @@
 #include "libavutil/pixdesc.h"
 #include "libavutil/slicethread.h"
 #include "libavutil/ppc/util_altivec.h"
+#include "libavutil/float2half.h"
 #include "libavutil/half2float.h"
 
 #define STR(s) AV_TOSTRING(s) // AV_STRINGIFY is too long
@@ -682,6 +684,49 @@ typedef struct SwsContext {
     atomic_int   data_unaligned_warned;
 
     Half2FloatTables *h2f_tables;
+
+    /**
+     * Reference-counted read-only filter banks backing hLumFilter,
+     * hChrFilter, vLumFilter and vChrFilter, in this order. A filter
+     * without a bank is owned by the context.
+     */
+    AVBufferRef *filter_bank[4];
+    struct SwsContextCache *filter_cache; ///< Cache the filters are shared through, if any.
+
+    /**
+     * State of the current sws_scale_rois() call, read by the slice
+     * threads, and the contexts used for the individual regions.
+     */
+    struct SwsContextCache *roi_cache;
+    const AVFrame          *roi_src;
+    const struct SwsROI    *rois;
+    int                  nb_rois;
+
+    /**
+     * Per-channel normalization of the float RGB outputs, in R, G, B order:
+     * out = (in - norm_mean) * norm_scale, with in in the [0, 1] range.
+     */
+    float norm_mean[3];
+    float norm_scale[3];
+
+    Float2HalfTables *f2h_tables;
+
+    /**
+     * Convert a line of 16-bit RGB samples to float, computing
+     * dst[i] = src[i] * coeffs[0] + coeffs[1] in single or half precision.
+     */
+    void (*rgb2float)(float *dst, const int32_t *src, const float *coeffs,
+                      int width);
+    void (*rgb2half)(uint16_t *dst, const int32_t *src, const float *coeffs,
+                     int width, const Float2HalfTables *tables);
+
+    /**
+     * Caller-provided executor for the slice jobs, used instead of
+     * slicethread when set. See sws_set_executor().
+     */
+    int (*execute)(void *opaque, void (*func)(void *arg, int jobnr, int nb_jobs),
+                   void *arg, int nb_jobs);
+    void *execute_opaque;
 } SwsContext;
 //FIXME check init (where 0)
 
@@ -851,6 +896,14 @@ static av_always_inline int isFloat16(enum AVPixelFormat pix_fmt)
     return (desc->flags & AV_PIX_FMT_FLAG_FLOAT) && desc->comp[0].depth == 16;
 }
 
+static av_always_inline int usesNormalization(const SwsContext *c)
+{
+    for (int i = 0; i < 3; i++)
+        if (c->norm_mean[i] != 0.0f || c->norm_scale[i] != 1.0f)
+            return 1;
+    return 0;
+}
+
 static av_always_inline int isALPHA(enum AVPixelFormat pix_fmt)
 {
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt);
@@ -1160,4 +1213,59 @@ void ff_sws_slice_worker(void *priv, int jobnr, int threadnr,
 
 //shuffle filter and filterPos for hyScale and hcScale filters in avx2
 int ff_shuffle_filter_coefficients(SwsContext *c, int* filterPos, int filterSize, int16_t *filter, int dstW);
+/**
+ * Parameters fully determining the coefficients computed for one filter,
+ * used to look up shared filter banks. Must be zeroed before being filled,
+ * as keys are compared with memcmp().
+ */
+typedef struct SwsFilterKey {
+    int xInc, srcW, dstW;
+    int filterAlign, one;
+    int flags, cpu_flags;
+    int srcPos, dstPos;
+    int shuffle;          ///< 0 for vertical filters, 1 + whether the AVX2 reordering applies otherwise
+    double param[2];
+} SwsFilterKey;
+
+/**
+ * An immutable set of filter coefficients, the data of a filter bank buffer.
+ */
+typedef struct SwsFilterBank {
+    int16_t *filter;
+    int32_t *filter_pos;
+    int      filter_size;
+} SwsFilterBank;
+
+/**
+ * Wrap filter coefficients into a read-only filter bank buffer. The bank
+ * takes ownership of filter and filter_pos, also on failure.
+ */
+AVBufferRef *ff_sws_filter_bank_alloc(int16_t *filter, int32_t *filter_pos,
+                                      int filter_size);
+
+/**
+ * Look up a filter bank in a cache.
+ *
+ * @return a new reference to the bank, or NULL if not found
+ */
+AVBufferRef *ff_sws_cache_get_filter(struct SwsContextCache *cache,
+                                     const SwsFilterKey *key);
+
+/**
+ * Add a filter bank to a cache, possibly evicting the least recently used
+ * one. The cache takes a new reference to bank.
+ */
+int ff_sws_cache_add_filter(struct SwsContextCache *cache,
+                            const SwsFilterKey *key, AVBufferRef *bank);
+
+/**
+ * Same as sws_context_cache_get(), with the float RGB output normalized
+ * as described by norm_mean and norm_scale.
+ */
+SwsContext *ff_sws_context_cache_get(struct SwsContextCache *cache,
+                                     int srcW, int srcH, enum AVPixelFormat srcFormat,
+                                     int dstW, int dstH, enum AVPixelFormat dstFormat,
+                                     int flags, const double *param,
+                                     const float *norm_mean, const float *norm_scale);
+
 #endif /* SWSCALE_SWSCALE_INTERNAL_H */
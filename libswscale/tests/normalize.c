@@ -0,0 +1,203 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check the normalized float RGB outputs against the plain float output
+ * normalized afterwards.
+ */
+
+#include <math.h>
+#include <stdio.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/intfloat.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+
+#define SRC_W 96
+#define SRC_H 64
+#define DST_W 56
+#define DST_H 40
+
+static const enum AVPixelFormat src_fmts[] = {
+    AV_PIX_FMT_YUV420P, AV_PIX_FMT_RGB24, AV_PIX_FMT_YUV444P10LE,
+};
+
+static const enum AVPixelFormat dst_fmts[] = {
+    AV_PIX_FMT_GBRPF32LE, AV_PIX_FMT_GBRPF32BE,
+    AV_PIX_FMT_GBRPF16LE, AV_PIX_FMT_GBRPF16BE,
+};
+
+/* R, G, B, as used for ImageNet models */
+static const float mean[3]  = { 0.485f, 0.456f, 0.406f };
+static const float scale[3] = { 1 / 0.229f, 1 / 0.224f, 1 / 0.225f };
+
+static float half2float(unsigned h)
+{
+    int exp = (h >> 10) & 0x1F;
+    float v = exp ? ldexpf((h & 0x3FF) | 0x400, exp - 25) : ldexpf(h & 0x3FF, -24);
+
+    return h & 0x8000 ? -v : v;
+}
+
+static float read_sample(const uint8_t *p, enum AVPixelFormat fmt)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    const int be = desc->flags & AV_PIX_FMT_FLAG_BE;
+
+    if (desc->comp[0].depth == 16)
+        return half2float(be ? AV_RB16(p) : AV_RL16(p));
+    return av_int2float(be ? AV_RB32(p) : AV_RL32(p));
+}
+
+static AVFrame *scale_frame(const AVFrame *src, enum AVPixelFormat dst_fmt,
+                            int normalize, int threads)
+{
+    struct SwsContext *sws = sws_alloc_context();
+    AVFrame *dst = av_frame_alloc();
+
+    if (!sws || !dst)
+        goto fail;
+
+    av_opt_set_int(sws, "srcw",       src->width,   0);
+    av_opt_set_int(sws, "srch",       src->height,  0);
+    av_opt_set_int(sws, "src_format", src->format,  0);
+    av_opt_set_int(sws, "dstw",       DST_W,        0);
+    av_opt_set_int(sws, "dsth",       DST_H,        0);
+    av_opt_set_int(sws, "dst_format", dst_fmt,      0);
+    av_opt_set_int(sws, "sws_flags",  SWS_BILINEAR, 0);
+    av_opt_set_int(sws, "threads",    threads,      0);
+    if (normalize) {
+        av_opt_set_double(sws, "norm_mean_r",  mean[0],  0);
+        av_opt_set_double(sws, "norm_mean_g",  mean[1],  0);
+        av_opt_set_double(sws, "norm_mean_b",  mean[2],  0);
+        av_opt_set_double(sws, "norm_scale_r", scale[0], 0);
+        av_opt_set_double(sws, "norm_scale_g", scale[1], 0);
+        av_opt_set_double(sws, "norm_scale_b", scale[2], 0);
+    }
+
+    if (sws_init_context(sws, NULL, NULL) < 0)
+        goto fail;
+
+    dst->width  = DST_W;
+    dst->height = DST_H;
+    dst->format = dst_fmt;
+    if (av_frame_get_buffer(dst, 0) < 0 ||
+        sws_scale_frame(sws, dst, src) < 0)
+        goto fail;
+
+    sws_freeContext(sws);
+    return dst;
+fail:
+    sws_freeContext(sws);
+    av_frame_free(&dst);
+    return NULL;
+}
+
+static int run_test(const AVFrame *src, enum AVPixelFormat dst_fmt, int threads)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dst_fmt);
+    const int bytes = desc->comp[0].depth / 8;
+    /* half precision keeps 11 significant bits and is truncated */
+    const float eps = bytes == 2 ? 1.0f / 512 : 1e-5f;
+    /* the planes are G, B, R */
+    static const int channel[3] = { 1, 2, 0 };
+    AVFrame *ref, *out;
+    int mismatch = 0;
+
+    ref = scale_frame(src, AV_PIX_FMT_GBRPF32LE, 0, 1);
+    out = scale_frame(src, dst_fmt, 1, threads);
+    if (!ref || !out) {
+        av_frame_free(&ref);
+        av_frame_free(&out);
+        return AVERROR(ENOMEM);
+    }
+
+    for (int p = 0; p < 3; p++) {
+        const int c = channel[p];
+
+        for (int y = 0; y < DST_H; y++) {
+            for (int x = 0; x < DST_W; x++) {
+                float r = read_sample(ref->data[p] + y * ref->linesize[p] + x * 4,
+                                      AV_PIX_FMT_GBRPF32LE);
+                float v = read_sample(out->data[p] + y * out->linesize[p] + x * bytes,
+                                      dst_fmt);
+                float expected = (r - mean[c]) * scale[c];
+
+                if (fabsf(v - expected) > eps * FFMAX(fabsf(expected), 1.0f))
+                    mismatch = 1;
+            }
+        }
+    }
+
+    printf("%s -> %s, %d threads: %s\n", av_get_pix_fmt_name(src->format),
+           av_get_pix_fmt_name(dst_fmt), threads, mismatch ? "mismatch" : "ok");
+
+    av_frame_free(&ref);
+    av_frame_free(&out);
+    return mismatch;
+}
+
+int main(void)
+{
+    AVLFG lfg;
+    int ret = 0;
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(src_fmts); i++) {
+        AVFrame *src = av_frame_alloc();
+
+        if (!src)
+            return 1;
+        src->width  = SRC_W;
+        src->height = SRC_H;
+        src->format = src_fmts[i];
+        if (av_frame_get_buffer(src, 0) < 0) {
+            av_frame_free(&src);
+            return 1;
+        }
+        for (int j = 0; j < src->buf[0]->size; j++)
+            src->buf[0]->data[j] = av_lfg_get(&lfg);
+        /* keep the high bit depth samples in range */
+        if (src->format == AV_PIX_FMT_YUV444P10LE)
+            for (int j = 0; j < src->buf[0]->size; j += 2)
+                AV_WL16(src->buf[0]->data + j, AV_RL16(src->buf[0]->data + j) & 0x3FF);
+
+        for (int j = 0; j < FF_ARRAY_ELEMS(dst_fmts); j++) {
+            for (int threads = 1; threads <= 2; threads++) {
+                int err = run_test(src, dst_fmts[j], threads);
+                if (err) {
+                    if (err < 0)
+                        fprintf(stderr, "%s -> %s failed\n",
+                                av_get_pix_fmt_name(src_fmts[i]),
+                                av_get_pix_fmt_name(dst_fmts[j]));
+                    ret = 1;
+                }
+            }
+        }
+
+        av_frame_free(&src);
+    }
+
+    return ret;
+}
@@ -0,0 +1,202 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Check that sws_scale_rois() gives the same output as scaling each region
+ * on its own with a dedicated context.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/lfg.h"
+#include "libavutil/opt.h"
+#include "libavutil/pixdesc.h"
+
+#include "libswscale/swscale.h"
+
+#define SRC_W   320
+#define SRC_H   240
+#define DST_W    48
+#define DST_H    40
+#define NB_ROIS  12
+
+static const struct {
+    enum AVPixelFormat src, dst;
+} conversions[] = {
+    { AV_PIX_FMT_YUV420P,     AV_PIX_FMT_RGB24     },
+    { AV_PIX_FMT_NV12,        AV_PIX_FMT_BGR24     },
+    { AV_PIX_FMT_YUV420P10LE, AV_PIX_FMT_GBRPF32LE },
+    { AV_PIX_FMT_RGB24,       AV_PIX_FMT_GBRP      },
+    { AV_PIX_FMT_YUYV422,     AV_PIX_FMT_BGRA      },
+};
+
+static AVFrame *alloc_frame(int width, int height, enum AVPixelFormat pix_fmt)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+    frame->width  = width;
+    frame->height = height;
+    frame->format = pix_fmt;
+    if (av_frame_get_buffer(frame, 0) < 0)
+        av_frame_free(&frame);
+    return frame;
+}
+
+/* scale a region on its own, the way callers did before sws_scale_rois() */
+static int scale_region(const AVFrame *src, const SwsROI *roi, AVFrame *dst)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src->format);
+    const int x = roi->x & ~((1 << desc->log2_chroma_w) - 1);
+    const int y = roi->y & ~((1 << desc->log2_chroma_h) - 1);
+    const uint8_t *data[4] = { NULL };
+    struct SwsContext *sws;
+    int step[4] = { 0 }, ret;
+
+    for (int i = 0; i < desc->nb_components; i++) {
+        const AVComponentDescriptor *comp = &desc->comp[i];
+        if (!step[comp->plane] || comp->step < step[comp->plane])
+            step[comp->plane] = comp->step;
+    }
+
+    for (int i = 0; i < 4 && src->data[i]; i++) {
+        const int hshift = (i == 1 || i == 2) ? desc->log2_chroma_w : 0;
+        const int vshift = (i == 1 || i == 2) ? desc->log2_chroma_h : 0;
+        data[i] = src->data[i] + (y >> vshift) * src->linesize[i] +
+                  (x >> hshift) * step[i];
+    }
+
+    sws = sws_getContext(roi->w, roi->h, src->format, dst->width, dst->height,
+                         dst->format, SWS_BILINEAR, NULL, NULL, NULL);
+    if (!sws)
+        return AVERROR(EINVAL);
+    ret = sws_scale(sws, data, src->linesize, 0, roi->h, dst->data, dst->linesize);
+    sws_freeContext(sws);
+    return ret;
+}
+
+static int run_test(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt,
+                    int threads, AVLFG *lfg)
+{
+    AVFrame *src = NULL, *out[NB_ROIS] = { NULL }, *ref[NB_ROIS] = { NULL };
+    struct SwsContext *sws = NULL;
+    SwsROI rois[NB_ROIS];
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dst_fmt);
+    int ret = AVERROR(ENOMEM), mismatch = 0;
+    int row_size[4];
+
+    av_image_fill_linesizes(row_size, dst_fmt, DST_W);
+
+    src = alloc_frame(SRC_W, SRC_H, src_fmt);
+    if (!src)
+        goto end;
+    for (int j = 0; j < src->buf[0]->size; j++)
+        src->buf[0]->data[j] = av_lfg_get(lfg);
+
+    for (int i = 0; i < NB_ROIS; i++) {
+        out[i] = alloc_frame(DST_W, DST_H, dst_fmt);
+        ref[i] = alloc_frame(DST_W, DST_H, dst_fmt);
+        if (!out[i] || !ref[i])
+            goto end;
+
+        /* repeat some sizes so that region contexts get reused */
+        rois[i].w = 8 + av_lfg_get(lfg) % (i < NB_ROIS / 2 ? 200 : 24);
+        rois[i].h = 8 + av_lfg_get(lfg) % (i < NB_ROIS / 2 ? 150 : 24);
+        rois[i].x = av_lfg_get(lfg) % (SRC_W - rois[i].w + 1);
+        rois[i].y = av_lfg_get(lfg) % (SRC_H - rois[i].h + 1);
+        memcpy(rois[i].dst,        out[i]->data,     sizeof(rois[i].dst));
+        memcpy(rois[i].dst_stride, out[i]->linesize, sizeof(rois[i].dst_stride));
+
+        ret = scale_region(src, &rois[i], ref[i]);
+        if (ret < 0)
+            goto end;
+    }
+
+    sws = sws_alloc_context();
+    if (!sws)
+        goto end;
+    av_opt_set_int(sws, "srcw",       SRC_W,        0);
+    av_opt_set_int(sws, "srch",       SRC_H,        0);
+    av_opt_set_int(sws, "src_format", src_fmt,      0);
+    av_opt_set_int(sws, "dstw",       DST_W,        0);
+    av_opt_set_int(sws, "dsth",       DST_H,        0);
+    av_opt_set_int(sws, "dst_format", dst_fmt,      0);
+    av_opt_set_int(sws, "sws_flags",  SWS_BILINEAR, 0);
+    av_opt_set_int(sws, "threads",    threads,      0);
+    ret = sws_init_context(sws, NULL, NULL);
+    if (ret < 0)
+        goto end;
+
+    /* twice, the second run going through the reused contexts */
+    for (int run = 0; run < 2 && !mismatch; run++) {
+        ret = sws_scale_rois(sws, src, rois, NB_ROIS);
+        if (ret < 0)
+            goto end;
+
+        for (int i = 0; i < NB_ROIS; i++)
+            for (int p = 0; p < 4 && out[i]->data[p]; p++) {
+                const int h = (p == 1 || p == 2) ? AV_CEIL_RSHIFT(DST_H, desc->log2_chroma_h) : DST_H;
+
+                /* only compare the visible part, the padding is not written */
+                for (int y = 0; y < h; y++)
+                    if (memcmp(out[i]->data[p] + y * out[i]->linesize[p],
+                               ref[i]->data[p] + y * ref[i]->linesize[p], row_size[p]))
+                        mismatch = 1;
+            }
+    }
+
+    printf("%s -> %s, %d threads: %s\n", av_get_pix_fmt_name(src_fmt),
+           av_get_pix_fmt_name(dst_fmt), threads, mismatch ? "mismatch" : "ok");
+    ret = mismatch;
+
+end:
+    sws_freeContext(sws);
+    av_frame_free(&src);
+    for (int i = 0; i < NB_ROIS; i++) {
+        av_frame_free(&out[i]);
+        av_frame_free(&ref[i]);
+    }
+    return ret;
+}
+
+int main(void)
+{
+    AVLFG lfg;
+    int ret = 0;
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(conversions); i++) {
+        for (int threads = 1; threads <= 3; threads += 2) {
+            int err = run_test(conversions[i].src, conversions[i].dst, threads, &lfg);
+            if (err) {
+                if (err < 0)
+                    fprintf(stderr, "%s -> %s failed\n",
+                            av_get_pix_fmt_name(conversions[i].src),
+                            av_get_pix_fmt_name(conversions[i].dst));
+                ret = 1;
+            }
+        }
+    }
+
+    return ret;
+}
@@ -208,6 +208,8 @@ static const FormatEntry format_entries[] = {
     [AV_PIX_FMT_GBRAP14BE]   = { 1, 1 },
     [AV_PIX_FMT_GBRP16LE]    = { 1, 1 },
     [AV_PIX_FMT_GBRP16BE]    = { 1, 1 },
+    [AV_PIX_FMT_GBRPF16LE]   = { 0, 1 },
+    [AV_PIX_FMT_GBRPF16BE]   = { 0, 1 },
     [AV_PIX_FMT_GBRPF32LE]   = { 1, 1 },
     [AV_PIX_FMT_GBRPF32BE]   = { 1, 1 },
     [AV_PIX_FMT_GBRAPF32LE]  = { 1, 1 },
@@ -795,6 +797,78 @@ done:
     return ret;
 }
 
+/**
+ * Set up the filter idx of c (see SwsContext.filter_bank) as a shared
+ * filter bank, taking it from c->filter_cache when possible. Horizontal
+ * filters are reordered for the SIMD scalers.
+ */
+static av_cold int init_filter_bank(SwsContext *c, int idx,
+                                    int16_t **outFilter, int32_t **filterPos,
+                                    int *outFilterSize, int xInc, int srcW,
+                                    int dstW, int filterAlign, int one,
+                                    int flags, int cpu_flags,
+                                    SwsVector *srcFilter, SwsVector *dstFilter,
+                                    double param[2], int srcPos, int dstPos,
+                                    int horizontal)
+{
+    /* custom filter vectors are not part of the key */
+    const int cacheable = c->filter_cache && !srcFilter && !dstFilter;
+    int16_t *filter = NULL;
+    int32_t *pos    = NULL;
+    int size, ret;
+    SwsFilterKey key;
+    SwsFilterBank *bank;
+
+    if (cacheable) {
+        memset(&key, 0, sizeof(key));
+        key.xInc        = xInc;
+        key.srcW        = srcW;
+        key.dstW        = dstW;
+        key.filterAlign = filterAlign;
+        key.one         = one;
+        key.flags       = flags;
+        key.cpu_flags   = cpu_flags;
+        key.srcPos      = srcPos;
+        key.dstPos      = dstPos;
+        key.shuffle     = horizontal ? 1 + (c->srcBpc == 8 && c->dstBpc <= 14) : 0;
+        key.param[0]    = param[0];
+        key.param[1]    = param[1];
+
+        c->filter_bank[idx] = ff_sws_cache_get_filter(c->filter_cache, &key);
+    }
+
+    if (!c->filter_bank[idx]) {
+        ret = initFilter(&filter, &pos, &size, xInc, srcW, dstW, filterAlign,
+                         one, flags, cpu_flags, srcFilter, dstFilter, param,
+                         srcPos, dstPos);
+        if (ret >= 0 && horizontal &&
+            ff_shuffle_filter_coefficients(c, pos, size, filter, dstW) < 0)
+            ret = AVERROR(ENOMEM);
+        if (ret < 0) {
+            av_free(filter);
+            av_free(pos);
+            return ret;
+        }
+
+        c->filter_bank[idx] = ff_sws_filter_bank_alloc(filter, pos, size);
+        if (!c->filter_bank[idx])
+            return AVERROR(ENOMEM);
+
+        if (cacheable) {
+            ret = ff_sws_cache_add_filter(c->filter_cache, &key, c->filter_bank[idx]);
+            if (ret < 0)
+                return ret;
+        }
+    }
+
+    bank = (SwsFilterBank *)c->filter_bank[idx]->data;
+    *outFilter     = bank->filter;
+    *filterPos     = bank->filter_pos;
+    *outFilterSize = bank->filter_size;
+
+    return 0;
+}
+
 static void fill_rgb2yuv_table(SwsContext *c, const int table[4], int dstRange)
 {
     int64_t W, V, Z, Cy, Cu, Cv;
@@ -1123,6 +1197,8 @@ int sws_setColorspaceDetails(struct SwsContext *c, const int inv_table[4],
                 return -1;
             c->cascaded_context[1]->srcRange = srcRange;
             c->cascaded_context[1]->dstRange = dstRange;
+            memcpy(c->cascaded_context[1]->norm_mean,  c->norm_mean,  sizeof(c->norm_mean));
+            memcpy(c->cascaded_context[1]->norm_scale, c->norm_scale, sizeof(c->norm_scale));
             ret = sws_init_context(c->cascaded_context[1], NULL , NULL);
             if (ret < 0)
                 return ret;
@@ -1193,6 +1269,12 @@ SwsContext *sws_alloc_context(void)
     return c;
 }
 
+void sws_set_executor(SwsContext *c, SwsExecuteFunc execute, void *opaque)
+{
+    c->execute        = execute;
+    c->execute_opaque = opaque;
+}
+
 static uint16_t * alloc_gamma_tbl(double e)
 {
     int i = 0;
@@ -1207,6 +1289,26 @@ static uint16_t * alloc_gamma_tbl(double e)
     return tbl;
 }
 
+/* last context of a cascade, which applies the output normalization */
+static SwsContext *get_cascade_output_context(SwsContext *c, int srcW, int srcH,
+                                              enum AVPixelFormat srcFormat, int flags,
+                                              SwsFilter *srcFilter, SwsFilter *dstFilter)
+{
+    SwsContext *out = sws_alloc_set_opts(srcW, srcH, srcFormat,
+                                         c->dstW, c->dstH, c->dstFormat,
+                                         flags, c->param);
+    if (!out)
+        return NULL;
+
+    memcpy(out->norm_mean,  c->norm_mean,  sizeof(out->norm_mean));
+    memcpy(out->norm_scale, c->norm_scale, sizeof(out->norm_scale));
+    if (sws_init_context(out, srcFilter, dstFilter) < 0) {
+        sws_freeContext(out);
+        return NULL;
+    }
+    return out;
+}
+
 static enum AVPixelFormat alphaless_fmt(enum AVPixelFormat fmt)
 {
     switch(fmt) {
@@ -1327,6 +1429,12 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
     }
     av_assert2(desc_src && desc_dst);
 
+    if (usesNormalization(c) && !(isPlanarRGB(dstFormat) && isFloat(dstFormat))) {
+        av_log(c, AV_LOG_ERROR, "Normalization is not supported for %s output\n",
+               av_get_pix_fmt_name(dstFormat));
+        return AVERROR(EINVAL);
+    }
+
     i = flags & (SWS_POINT         |
                  SWS_AREA          |
                  SWS_BILINEAR      |
@@ -1619,9 +1727,8 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
             if (ret < 0)
                 return ret;
 
-            c->cascaded_context[2] = sws_getContext(dstW, dstH, tmpFmt,
-                                                dstW, dstH, dstFormat,
-                                                flags, NULL, NULL, c->param);
+            c->cascaded_context[2] = get_cascade_output_context(c, dstW, dstH, tmpFmt,
+                                                                flags, NULL, NULL);
             if (!c->cascaded_context[2])
                 return AVERROR(ENOMEM);
         }
@@ -1645,9 +1752,8 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
             if (!c->cascaded_context[0])
                 return AVERROR(ENOMEM);
 
-            c->cascaded_context[1] = sws_getContext(srcW, srcH, tmpFormat,
-                                                    dstW, dstH, dstFormat,
-                                                    flags, NULL, dstFilter, c->param);
+            c->cascaded_context[1] = get_cascade_output_context(c, srcW, srcH, tmpFormat,
+                                                                flags, NULL, dstFilter);
             if (!c->cascaded_context[1])
                 return AVERROR(ENOMEM);
             return 0;
@@ -1700,6 +1806,8 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
 
                 c->cascaded_context[1]->srcRange = c->srcRange;
                 c->cascaded_context[1]->dstRange = c->dstRange;
+                memcpy(c->cascaded_context[1]->norm_mean,  c->norm_mean,  sizeof(c->norm_mean));
+                memcpy(c->cascaded_context[1]->norm_scale, c->norm_scale, sizeof(c->norm_scale));
                 ret = sws_init_context(c->cascaded_context[1], srcFilter , dstFilter);
                 if (ret < 0)
                     return ret;
@@ -1724,8 +1832,8 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
         return 0;
     }
 
-    /* unscaled special cases */
-    if (unscaled && !usesHFilter && !usesVFilter) {
+    /* unscaled special cases, none of which normalize */
+    if (unscaled && !usesHFilter && !usesVFilter && !usesNormalization(c)) {
         ff_get_unscaled_swscale(c);
 
         if (c->convert_unscaled) {
@@ -1813,28 +1921,24 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                                     have_lsx(cpu_flags)    ? 8 :
                                     have_lasx(cpu_flags)   ? 8 : 1;
 
-            if ((ret = initFilter(&c->hLumFilter, &c->hLumFilterPos,
+            if ((ret = init_filter_bank(c, 0, &c->hLumFilter, &c->hLumFilterPos,
                            &c->hLumFilterSize, c->lumXInc,
                            srcW, dstW, filterAlign, 1 << 14,
                            (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
                            cpu_flags, srcFilter->lumH, dstFilter->lumH,
                            c->param,
                            get_local_pos(c, 0, 0, 0),
-                           get_local_pos(c, 0, 0, 0))) < 0)
+                           get_local_pos(c, 0, 0, 0), 1)) < 0)
                 goto fail;
-            if (ff_shuffle_filter_coefficients(c, c->hLumFilterPos, c->hLumFilterSize, c->hLumFilter, dstW) < 0)
-                goto nomem;
-            if ((ret = initFilter(&c->hChrFilter, &c->hChrFilterPos,
+            if ((ret = init_filter_bank(c, 1, &c->hChrFilter, &c->hChrFilterPos,
                            &c->hChrFilterSize, c->chrXInc,
                            c->chrSrcW, c->chrDstW, filterAlign, 1 << 14,
                            (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
                            cpu_flags, srcFilter->chrH, dstFilter->chrH,
                            c->param,
                            get_local_pos(c, c->chrSrcHSubSample, c->src_h_chr_pos, 0),
-                           get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0))) < 0)
+                           get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0), 1)) < 0)
                 goto fail;
-            if (ff_shuffle_filter_coefficients(c, c->hChrFilterPos, c->hChrFilterSize, c->hChrFilter, c->chrDstW) < 0)
-                goto nomem;
         }
     } // initialize horizontal stuff
 
@@ -1844,22 +1948,22 @@ static av_cold int sws_init_single_context(SwsContext *c, SwsFilter *srcFilter,
                                 PPC_ALTIVEC(cpu_flags) ? 8 :
                                 have_neon(cpu_flags)   ? 2 : 1;
 
-        if ((ret = initFilter(&c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
+        if ((ret = init_filter_bank(c, 2, &c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
                        c->lumYInc, srcH, dstH, filterAlign, (1 << 12),
                        (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
                        cpu_flags, srcFilter->lumV, dstFilter->lumV,
                        c->param,
                        get_local_pos(c, 0, 0, 1),
-                       get_local_pos(c, 0, 0, 1))) < 0)
+                       get_local_pos(c, 0, 0, 1), 0)) < 0)
             goto fail;
-        if ((ret = initFilter(&c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
+        if ((ret = init_filter_bank(c, 3, &c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
                        c->chrYInc, c->chrSrcH, c->chrDstH,
                        filterAlign, (1 << 12),
                        (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
                        cpu_flags, srcFilter->chrV, dstFilter->chrV,
                        c->param,
                        get_local_pos(c, c->chrSrcVSubSample, c->src_v_chr_pos, 1),
-                       get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1))) < 0)
+                       get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1), 0)) < 0)
 
             goto fail;
 
@@ -1969,9 +2073,8 @@ fail: // FIXME replace things by appropriate error codes
         if (!c->cascaded_context[0])
             return AVERROR(ENOMEM);
 
-        c->cascaded_context[1] = sws_getContext(tmpW, tmpH, tmpFormat,
-                                                dstW, dstH, dstFormat,
-                                                flags, NULL, dstFilter, c->param);
+        c->cascaded_context[1] = get_cascade_output_context(c, tmpW, tmpH, tmpFormat,
+                                                            flags, NULL, dstFilter);
         if (!c->cascaded_context[1])
             return AVERROR(ENOMEM);
         return 0;
@@ -1982,39 +2085,58 @@ fail: // FIXME replace things by appropriate error codes
 static int context_init_threaded(SwsContext *c,
                                  SwsFilter *src_filter, SwsFilter *dst_filter)
 {
+    SwsContextCache *tmp_cache = NULL, *cache = c->filter_cache;
     int ret;
 
-    ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
-                                    ff_sws_slice_worker, NULL, c->nb_threads);
-    if (ret == AVERROR(ENOSYS)) {
-        c->nb_threads = 1;
-        return 0;
-    } else if (ret < 0)
-        return ret;
+    if (c->execute) {
+        if (!c->nb_threads)
+            c->nb_threads = av_cpu_count();
+        if (c->nb_threads == 1)
+            return 0;
+    } else {
+        ret = avpriv_slicethread_create(&c->slicethread, (void*)c,
+                                        ff_sws_slice_worker, NULL, c->nb_threads);
+        if (ret == AVERROR(ENOSYS)) {
+            c->nb_threads = 1;
+            return 0;
+        } else if (ret < 0)
+            return ret;
 
-    c->nb_threads = ret;
+        c->nb_threads = ret;
+    }
 
     c->slice_ctx = av_calloc(c->nb_threads, sizeof(*c->slice_ctx));
     c->slice_err = av_calloc(c->nb_threads, sizeof(*c->slice_err));
     if (!c->slice_ctx || !c->slice_err)
         return AVERROR(ENOMEM);
 
+    /* the slice contexts have identical filters, compute them only once */
+    if (!cache) {
+        cache = tmp_cache = sws_context_cache_alloc();
+        if (!cache)
+            return AVERROR(ENOMEM);
+    }
+
     for (int i = 0; i < c->nb_threads; i++) {
         c->slice_ctx[i] = sws_alloc_context();
-        if (!c->slice_ctx[i])
-            return AVERROR(ENOMEM);
+        if (!c->slice_ctx[i]) {
+            ret = AVERROR(ENOMEM);
+            goto end;
+        }
 
         c->slice_ctx[i]->parent = c;
 
         ret = av_opt_copy((void*)c->slice_ctx[i], (void*)c);
         if (ret < 0)
-            return ret;
+            goto end;
 
         c->slice_ctx[i]->nb_threads = 1;
 
+        c->slice_ctx[i]->filter_cache = cache;
         ret = sws_init_single_context(c->slice_ctx[i], src_filter, dst_filter);
+        c->slice_ctx[i]->filter_cache = NULL;
         if (ret < 0)
-            return ret;
+            goto end;
 
         c->nb_slice_ctx++;
 
@@ -2025,7 +2147,10 @@ static int context_init_threaded(SwsContext *c,
         }
     }
 
-    return 0;
+    ret = 0;
+end:
+    sws_context_cache_free(&tmp_cache);
+    return ret;
 }
 
 av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
@@ -2417,6 +2542,19 @@ fail:
     return NULL;
 }
 
+static void free_filter(SwsContext *c, int idx, int16_t **filter,
+                        int32_t **filter_pos)
+{
+    if (c->filter_bank[idx]) {
+        av_buffer_unref(&c->filter_bank[idx]);
+        *filter     = NULL;
+        *filter_pos = NULL;
+    } else {
+        av_freep(filter);
+        av_freep(filter_pos);
+    }
+}
+
 void sws_freeContext(SwsContext *c)
 {
     int i;
@@ -2438,20 +2576,17 @@ void sws_freeContext(SwsContext *c)
 
     av_freep(&c->src_ranges.ranges);
 
-    av_freep(&c->vLumFilter);
-    av_freep(&c->vChrFilter);
-    av_freep(&c->hLumFilter);
-    av_freep(&c->hChrFilter);
+    sws_context_cache_free(&c->roi_cache);
+
+    free_filter(c, 0, &c->hLumFilter, &c->hLumFilterPos);
+    free_filter(c, 1, &c->hChrFilter, &c->hChrFilterPos);
+    free_filter(c, 2, &c->vLumFilter, &c->vLumFilterPos);
+    free_filter(c, 3, &c->vChrFilter, &c->vChrFilterPos);
 #if HAVE_ALTIVEC
     av_freep(&c->vYCoeffsBank);
     av_freep(&c->vCCoeffsBank);
 #endif
 
-    av_freep(&c->vLumFilterPos);
-    av_freep(&c->vChrFilterPos);
-    av_freep(&c->hLumFilterPos);
-    av_freep(&c->hChrFilterPos);
-
 #if HAVE_MMX_INLINE
 #if USE_MMAP
     if (c->lumMmxextFilterCode)
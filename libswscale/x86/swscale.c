@@ -744,7 +744,8 @@ switch(c->dstBpc){ \
         }
     }
 
-    if(c->flags & SWS_FULL_CHR_H_INT) {
+    /* the float outputs of yuv2gbrp do not normalize */
+    if (c->flags & SWS_FULL_CHR_H_INT && !(isFloat(c->dstFormat) && usesNormalization(c))) {
 
         /* yuv2gbrp uses the SwsContext for yuv coefficients
            if struct offsets change the asm needs to be updated too */
@@ -0,0 +1,115 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/mem_internal.h"
+
+#include "libswresample/swresample_internal.h"
+#include "libswresample/resample.h"
+
+#include "checkasm.h"
+
+#define DST_LEN 256
+#define SRC_LEN (3 * DST_LEN + 256)
+
+static void randomize_float(float *buf, int len)
+{
+    for (int i = 0; i < len; i++)
+        buf[i] = (int32_t)rnd() / (float)(1U << 31);
+}
+
+static void randomize_double(double *buf, int len)
+{
+    for (int i = 0; i < len; i++)
+        buf[i] = (int32_t)rnd() / (double)(1U << 31);
+}
+
+static void check_resample(enum AVSampleFormat fmt)
+{
+    static const struct {
+        int in_rate, out_rate;
+    } rates[] = {
+        { 44100, 48000 },
+        { 48000, 22050 },
+        { 22050, 48000 },
+    };
+    const int is_float = fmt == AV_SAMPLE_FMT_FLTP;
+    const char *name = is_float ? "float" : "double";
+    LOCAL_ALIGNED_32(uint8_t, src,  [SRC_LEN * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [DST_LEN * sizeof(double)]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [DST_LEN * sizeof(double)]);
+
+    declare_func(int, ResampleContext *c, void *dst, const void *src,
+                 int n, int update_ctx);
+
+    if (is_float)
+        randomize_float((float *)src, SRC_LEN);
+    else
+        randomize_double((double *)src, SRC_LEN);
+
+    for (int r = 0; r < FF_ARRAY_ELEMS(rates); r++) {
+        ResampleContext *c = swri_resampler.init(NULL, rates[r].out_rate, rates[r].in_rate,
+                                                 32, 10, 1, 0.97, fmt,
+                                                 SWR_FILTER_TYPE_KAISER, 9, 20, 0, 0);
+        if (!c) {
+            fail();
+            continue;
+        }
+
+        swri_resample_dsp_init(c);
+
+        for (int linear = 0; linear < 2; linear++) {
+            if (check_func(linear ? c->dsp.resample_linear : c->dsp.resample_common,
+                           "resample_%s_%s_%d", linear ? "linear" : "common",
+                           name, c->filter_length)) {
+                ResampleContext c0 = *c, c1 = *c;
+                int ret0, ret1;
+
+                c0.index = c1.index = rnd() % c->phase_count;
+                c0.frac  = c1.frac  = rnd() % c->src_incr;
+
+                memset(dst0, 0, DST_LEN * sizeof(double));
+                memset(dst1, 0, DST_LEN * sizeof(double));
+                ret0 = call_ref(&c0, dst0, src, DST_LEN, 1);
+                ret1 = call_new(&c1, dst1, src, DST_LEN, 1);
+                if (ret0 != ret1 || c0.index != c1.index || c0.frac != c1.frac)
+                    fail();
+                if (is_float ? !float_near_abs_eps_array((float *)dst0, (float *)dst1,
+                                                          1e-5, DST_LEN)
+                             : !double_near_abs_eps_array((double *)dst0, (double *)dst1,
+                                                          1e-12, DST_LEN))
+                    fail();
+
+                bench_new(&c1, dst1, src, DST_LEN, 0);
+            }
+        }
+
+        swri_resampler.free(&c);
+    }
+}
+
+void checkasm_check_sw_resample(void)
+{
+    check_resample(AV_SAMPLE_FMT_FLTP);
+    report("resample_float");
+
+    check_resample(AV_SAMPLE_FMT_DBLP);
+    report("resample_double");
+}
@@ -22,6 +22,7 @@
 #include "libavutil/common.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/pixdesc.h"
 
 #include "libswscale/swscale.h"
 #include "libswscale/swscale_internal.h"
@@ -262,10 +263,14 @@ static void check_hscale(void)
 #define FILTER_SIZES 6
     static const int filter_sizes[FILTER_SIZES] = { 4, 8, 12, 16, 32, 40 };
 
-#define HSCALE_PAIRS 2
+#define HSCALE_PAIRS 6
     static const int hscale_pairs[HSCALE_PAIRS][2] = {
         { 8, 14 },
         { 8, 18 },
+        { 10, 14 },
+        { 10, 18 },
+        { 16, 14 },
+        { 16, 18 },
     };
 
 #define LARGEST_INPUT_SIZE 512
@@ -275,8 +280,8 @@ static void check_hscale(void)
     int i, j, fsi, hpi, width, dstWi;
     struct SwsContext *ctx;
 
-    // padded
-    LOCAL_ALIGNED_32(uint8_t, src, [FFALIGN(SRC_PIXELS + MAX_FILTER_WIDTH - 1, 4)]);
+    // padded, room for 16-bit input
+    LOCAL_ALIGNED_32(uint16_t, src, [FFALIGN(SRC_PIXELS + MAX_FILTER_WIDTH - 1, 4)]);
     LOCAL_ALIGNED_32(uint32_t, dst0, [SRC_PIXELS]);
     LOCAL_ALIGNED_32(uint32_t, dst1, [SRC_PIXELS]);
 
@@ -296,9 +301,25 @@ static void check_hscale(void)
     if (sws_init_context(ctx, NULL, NULL) < 0)
         fail();
 
-    randomize_buffers(src, SRC_PIXELS + MAX_FILTER_WIDTH - 1);
-
     for (hpi = 0; hpi < HSCALE_PAIRS; hpi++) {
+        // the C functions for more than 8 bits take the depth from srcFormat
+        switch (hscale_pairs[hpi][0]) {
+        case 8:
+            ctx->srcFormat = AV_PIX_FMT_YUV420P;
+            randomize_buffers((uint8_t *)src, SRC_PIXELS + MAX_FILTER_WIDTH - 1);
+            break;
+        case 10:
+            ctx->srcFormat = AV_PIX_FMT_YUV420P10;
+            for (i = 0; i < SRC_PIXELS + MAX_FILTER_WIDTH - 1; i++)
+                src[i] = rnd() & 0x3ff;
+            break;
+        default:
+            ctx->srcFormat = AV_PIX_FMT_YUV420P16;
+            for (i = 0; i < SRC_PIXELS + MAX_FILTER_WIDTH - 1; i++)
+                src[i] = rnd();
+            break;
+        }
+
         for (fsi = 0; fsi < FILTER_SIZES; fsi++) {
             for (dstWi = 0; dstWi < INPUT_SIZES; dstWi++) {
                 width = filter_sizes[fsi];
@@ -346,11 +367,84 @@ static void check_hscale(void)
                     memset(dst0, 0, SRC_PIXELS * sizeof(dst0[0]));
                     memset(dst1, 0, SRC_PIXELS * sizeof(dst1[0]));
 
-                    call_ref(NULL, dst0, ctx->dstW, src, filter, filterPos, width);
-                    call_new(NULL, dst1, ctx->dstW, src, filterAvx2, filterPosAvx, width);
+                    call_ref(ctx, dst0, ctx->dstW, (const uint8_t *)src, filter, filterPos, width);
+                    call_new(ctx, dst1, ctx->dstW, (const uint8_t *)src, filterAvx2, filterPosAvx, width);
                     if (memcmp(dst0, dst1, ctx->dstW * sizeof(dst0[0])))
                         fail();
-                    bench_new(NULL, dst0, ctx->dstW, src, filter, filterPosAvx, width);
+                    bench_new(ctx, dst0, ctx->dstW, (const uint8_t *)src, filter, filterPosAvx, width);
+                }
+            }
+        }
+    }
+    sws_freeContext(ctx);
+}
+
+// room for the SIMD versions processing whole vectors
+#define INPUT_PADDING 64
+
+// same filters as check_yuv2yuvX(), summing to 1 << 12 without overflowing
+static void init_vfilter(int16_t *filter, int filter_size)
+{
+    for (int i = 0; i < filter_size; i++)
+        filter[i] = -((1 << 12) / (filter_size - 1));
+    filter[rnd() % filter_size] = (1 << 13) - 1;
+}
+
+static void check_yuv2nv12_cX(void)
+{
+    static const enum AVPixelFormat fmts[] = { AV_PIX_FMT_NV12, AV_PIX_FMT_NV21 };
+    static const int input_sizes[] = {8, 24, 127, 144, 256, 512};
+    static const int filter_sizes[] = {2, 4, 8, 16};
+    struct SwsContext *ctx;
+    const AVPixFmtDescriptor *desc;
+    const int16_t *u[LARGEST_FILTER], *v[LARGEST_FILTER];
+    int fmi, isi, fsi;
+
+    declare_func(void, enum AVPixelFormat dstFormat, const uint8_t *dither,
+                 const int16_t *filter, int filterSize,
+                 const int16_t **u, const int16_t **v,
+                 uint8_t *dest, int dstW);
+
+    LOCAL_ALIGNED_32(int16_t, src_u, [LARGEST_FILTER * (LARGEST_INPUT_SIZE + INPUT_PADDING)]);
+    LOCAL_ALIGNED_32(int16_t, src_v, [LARGEST_FILTER * (LARGEST_INPUT_SIZE + INPUT_PADDING)]);
+    LOCAL_ALIGNED_32(int16_t, filter, [LARGEST_FILTER]);
+    LOCAL_ALIGNED_32(uint8_t, dither, [8]);
+    LOCAL_ALIGNED_32(uint8_t, dst0, [(LARGEST_INPUT_SIZE + INPUT_PADDING) * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst1, [(LARGEST_INPUT_SIZE + INPUT_PADDING) * 2]);
+
+    randomize_buffers((uint8_t *)src_u, LARGEST_FILTER * (LARGEST_INPUT_SIZE + INPUT_PADDING) * 2);
+    randomize_buffers((uint8_t *)src_v, LARGEST_FILTER * (LARGEST_INPUT_SIZE + INPUT_PADDING) * 2);
+    randomize_buffers(dither, 8);
+    for (int i = 0; i < LARGEST_FILTER; i++) {
+        u[i] = src_u + i * (LARGEST_INPUT_SIZE + INPUT_PADDING);
+        v[i] = src_v + i * (LARGEST_INPUT_SIZE + INPUT_PADDING);
+    }
+
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+
+    for (fmi = 0; fmi < FF_ARRAY_ELEMS(fmts); fmi++) {
+        desc = av_pix_fmt_desc_get(fmts[fmi]);
+        ctx->dstFormat = fmts[fmi];
+        ff_sws_init_scale(ctx);
+        for (isi = 0; isi < FF_ARRAY_ELEMS(input_sizes); isi++) {
+            const int dstW = input_sizes[isi];
+
+            for (fsi = 0; fsi < FF_ARRAY_ELEMS(filter_sizes); fsi++) {
+                const int filter_size = filter_sizes[fsi];
+
+                init_vfilter(filter, filter_size);
+                if (check_func(ctx->yuv2nv12cX, "yuv2%s_cX_%d_%d", desc->name, filter_size, dstW)) {
+                    memset(dst0, 0, (LARGEST_INPUT_SIZE + INPUT_PADDING) * 2);
+                    memset(dst1, 0, (LARGEST_INPUT_SIZE + INPUT_PADDING) * 2);
+
+                    call_ref(ctx->dstFormat, dither, filter, filter_size, u, v, dst0, dstW);
+                    call_new(ctx->dstFormat, dither, filter, filter_size, u, v, dst1, dstW);
+                    if (memcmp(dst0, dst1, dstW * 2))
+                        fail();
+                    if (dstW == LARGEST_INPUT_SIZE)
+                        bench_new(ctx->dstFormat, dither, filter, filter_size, u, v, dst1, dstW);
                 }
             }
         }
@@ -368,4 +462,6 @@ void checkasm_check_sw_scale(void)
     check_yuv2yuvX(0);
     check_yuv2yuvX(1);
     report("yuv2yuvX");
+    check_yuv2nv12_cX();
+    report("yuv2nv12cX");
 }
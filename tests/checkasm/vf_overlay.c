@@ -0,0 +1,117 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_overlay_init.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH 256
+#define WIDTH_PADDED (WIDTH + 64)
+/* two alpha rows of twice the width, for the subsampled kernels */
+#define ALPHA_SIZE (4 * WIDTH_PADDED)
+/* room for interleaved chroma */
+#define DST_SIZE (2 * WIDTH_PADDED)
+
+#define randomize_buffers(buf, size, mask)            \
+    do {                                              \
+        for (int j = 0; j < size; j++)                \
+            buf[j] = rnd() & (mask);                  \
+    } while (0)
+
+static void check_overlay_row(int format, enum AVPixelFormat pix_fmt,
+                              int plane, int bytes, int dst_step,
+                              const char *name)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,     [WIDTH_PADDED * 2]);
+    LOCAL_ALIGNED_32(uint8_t, alpha,   [ALPHA_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst,     [DST_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [DST_SIZE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [DST_SIZE * 2]);
+    const int mask = bytes == 2 ? 0x3ff : 0xff;
+    const ptrdiff_t alinesize = 2 * WIDTH_PADDED * bytes;
+    OverlayContext s;
+
+    declare_func(int, uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                 int w, ptrdiff_t alinesize);
+
+    if (bytes == 2) {
+        uint16_t *src16 = (uint16_t *)src, *alpha16 = (uint16_t *)alpha;
+        uint16_t *dst16 = (uint16_t *)dst;
+
+        randomize_buffers(src16,   WIDTH_PADDED, mask);
+        randomize_buffers(alpha16, ALPHA_SIZE,   mask);
+        randomize_buffers(dst16,   DST_SIZE,     mask);
+    } else {
+        randomize_buffers(src,     WIDTH_PADDED, mask);
+        randomize_buffers(alpha,   ALPHA_SIZE,   mask);
+        randomize_buffers(dst,     DST_SIZE,     mask);
+    }
+
+    /* make sure the fully transparent and fully opaque paths are hit too */
+    if (bytes == 2) {
+        AV_WN16A(alpha, 0);
+        AV_WN16A(alpha + 2, mask);
+    } else {
+        alpha[0] = 0;
+        alpha[1] = mask;
+    }
+
+    ff_overlay_init(&s, format, pix_fmt, 0, 0);
+
+    if (check_func(s.blend_row[plane], "overlay_row_%s", name)) {
+        for (int w = 1; w <= WIDTH; w += w < 40 ? 1 : 37) {
+            int c_ref, c_new, done;
+
+            memcpy(dst_ref, dst, DST_SIZE * bytes);
+            memcpy(dst_new, dst, DST_SIZE * bytes);
+            c_ref = call_ref(dst_ref, NULL, src, alpha, w, alinesize);
+            c_new = call_new(dst_new, NULL, src, alpha, w, alinesize);
+
+            /* the SIMD versions may leave a tail to the generic code */
+            done = c_new * dst_step * bytes;
+            if (c_new < 0 || c_new > c_ref ||
+                memcmp(dst_ref, dst_new, done) ||
+                memcmp(dst_new + done, dst + done, DST_SIZE * bytes - done))
+                fail();
+        }
+        bench_new(dst_new, NULL, src, alpha, WIDTH, alinesize);
+    }
+}
+
+void checkasm_check_vf_overlay(void)
+{
+    check_overlay_row(OVERLAY_FORMAT_YUV444,    AV_PIX_FMT_YUV444P,    0, 1, 1, "44");
+    report("overlay_row_44");
+
+    check_overlay_row(OVERLAY_FORMAT_YUV422,    AV_PIX_FMT_YUV422P,    1, 1, 1, "22");
+    report("overlay_row_22");
+
+    check_overlay_row(OVERLAY_FORMAT_YUV420,    AV_PIX_FMT_YUV420P,    1, 1, 1, "20");
+    report("overlay_row_20");
+
+    check_overlay_row(OVERLAY_FORMAT_YUV420,    AV_PIX_FMT_NV12,       1, 1, 2, "20_nv12");
+    report("overlay_row_20_nv12");
+
+    check_overlay_row(OVERLAY_FORMAT_YUV444P10, AV_PIX_FMT_YUV444P10,  0, 2, 1, "44_10");
+    report("overlay_row_44_10");
+
+    check_overlay_row(OVERLAY_FORMAT_YUV422P10, AV_PIX_FMT_YUV422P10,  1, 2, 1, "22_10");
+    report("overlay_row_22_10");
+}
@@ -41,6 +41,14 @@ fate-ffmpeg-filter_colorkey: CMD = framecrc -auto_conversion_filters -idct simpl
 FATE_FFMPEG-$(call FILTERFRAMECRC, COLOR) += fate-ffmpeg-lavfi
 fate-ffmpeg-lavfi: CMD = framecrc -lavfi color=d=1:r=5 -fflags +bitexact
 
+# limiting the number of running tasks must not change the output
+FATE_FFMPEG-$(call FILTERFRAMECRC, TESTSRC2 SPLIT HFLIP) += fate-ffmpeg-sched_threads fate-ffmpeg-sched_threads-1 fate-ffmpeg-sched_threads-2
+fate-ffmpeg-sched_threads: CMD = framecrc -filter_complex "testsrc2=d=1:r=5,split[a][b]\;[b]hflip[b1]" -map "[a]" -map "[b1]" -fflags +bitexact
+fate-ffmpeg-sched_threads-1: CMD = framecrc -sched_threads 1 -filter_complex "testsrc2=d=1:r=5,split[a][b]\;[b]hflip[b1]" -map "[a]" -map "[b1]" -fflags +bitexact
+fate-ffmpeg-sched_threads-1: REF = $(SRC_PATH)/tests/ref/fate/ffmpeg-sched_threads
+fate-ffmpeg-sched_threads-2: CMD = framecrc -sched_threads 2 -filter_complex "testsrc2=d=1:r=5,split[a][b]\;[b]hflip[b1]" -map "[a]" -map "[b1]" -fflags +bitexact
+fate-ffmpeg-sched_threads-2: REF = $(SRC_PATH)/tests/ref/fate/ffmpeg-sched_threads
+
 FATE_SAMPLES_FFMPEG-$(call ENCDEC2, MPEG4, RAWVIDEO, AVI, RAWVIDEO_DEMUXER FRAMECRC_MUXER) += fate-force_key_frames
 fate-force_key_frames: tests/data/vsynth_lena.yuv
 fate-force_key_frames: CMD = enc_dec \
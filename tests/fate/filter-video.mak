@@ -124,6 +124,9 @@ FATE_FILTER-$(call FILTERFRAMECRC, FRAMERATE TESTSRC2 FORMAT SCALE) += fate-filt
 fate-filter-framerate-12bit-up: CMD = framecrc -lavfi testsrc2=r=50:d=1,format=pix_fmts=yuv422p12le,scale,framerate=fps=60,scale -t 1 -pix_fmt yuv422p12le
 fate-filter-framerate-12bit-down: CMD = framecrc -lavfi testsrc2=r=60:d=1,format=pix_fmts=yuv422p12le,scale,framerate=fps=50,scale -t 1 -pix_fmt yuv422p12le
 
+FATE_FILTER-$(call FILTERFRAMECRC, TESTSRC2 SCALE FORMAT) += fate-filter-scale-slice-threads
+fate-filter-scale-slice-threads: CMD = framecrc -filter_complex_threads 3 -lavfi testsrc2=s=1920x1080:r=2:d=1,scale=1280:720:flags=bicubic+accurate_rnd+bitexact,format=rgb24 -pix_fmt rgb24
+
 FATE_FILTER-$(call FILTERFRAMECRC, MINTERPOLATE TESTSRC2) += fate-filter-minterpolate-up fate-filter-minterpolate-down
 fate-filter-minterpolate-up: CMD = framecrc -lavfi testsrc2=r=2:d=10,minterpolate=fps=10 -t 1
 fate-filter-minterpolate-down: CMD = framecrc -lavfi testsrc2=r=2:d=10,minterpolate=fps=1 -t 1
@@ -137,6 +140,65 @@ fate-filter-colorchannelmixer: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf scale,fo
 FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_DRAWBOX_FILTER) += fate-filter-drawbox
 fate-filter-drawbox: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf drawbox=224:24:88:72:red@0.5
 
+FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_DRAWBOX_FILTER) += fate-filter-drawbox-threads
+fate-filter-drawbox-threads: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf drawbox=224:24:88:72:red@0.5 -filter_threads 4
+fate-filter-drawbox-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-drawbox
+
+FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_DRAWGRID_FILTER) += fate-filter-drawgrid fate-filter-drawgrid-threads
+fate-filter-drawgrid: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf drawgrid=w=37:h=29:t=3:c=yellow@0.5
+fate-filter-drawgrid-threads: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf drawgrid=w=37:h=29:t=3:c=yellow@0.5 -filter_threads 4
+fate-filter-drawgrid-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-drawgrid
+
+FATE_FILTER_VSYNTH_PGMYUV-$(call ALLYES, SPLIT_FILTER CHROMAHOLD_FILTER VSTACK_FILTER COPY_FILTER) += fate-filter-chromahold-split fate-filter-chromahold-split-copy
+fate-filter-chromahold-split: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex "split[a][b]\;[a]chromahold=color=red:similarity=0.3[a1]\;[a1][b]vstack" -frames:v 10
+fate-filter-chromahold-split-copy: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex "split[a][b]\;[a]copy,chromahold=color=red:similarity=0.3[a1]\;[a1][b]vstack" -frames:v 10
+fate-filter-chromahold-split-copy: REF = $(SRC_PATH)/tests/ref/fate/filter-chromahold-split
+
+FATE_FILTER_VSYNTH_PGMYUV-$(call ALLYES, SPLIT_FILTER HFLIP_FILTER VFLIP_FILTER) += fate-filter-split fate-filter-split-queue
+fate-filter-split: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex "split=3[a][b][c]\;[b]hflip[b1]\;[c]vflip[c1]" -map "[a]" -map "[b1]" -map "[c1]" -frames:v 10
+fate-filter-split-queue: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex "split=3:queue_size=2:policies=block|drop_oldest|drop_newest[a][b][c]\;[b]hflip[b1]\;[c]vflip[c1]" -map "[a]" -map "[b1]" -map "[c1]" -frames:v 10
+fate-filter-split-queue: REF = $(SRC_PATH)/tests/ref/fate/filter-split
+
+# concat reads its inputs one after another, so the last two outputs are
+# not consumed until the first one ends and their queues overflow
+FATE_FILTER_VSYNTH_PGMYUV-$(call ALLYES, TRIM_FILTER SPLIT_FILTER CONCAT_FILTER) += fate-filter-split-queue-drop
+fate-filter-split-queue-drop: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex "trim=end_frame=6,split=3:queue_size=2:policies=block|drop_oldest|drop_newest[a][b][c]\;[a][b][c]concat=n=3"
+
+FATE_FILTER-$(call ALLYES, SPLIT_FILTER) += fate-filter-split-queue-policies
+fate-filter-split-queue-policies: libavfilter/tests/splitqueue$(EXESUF)
+fate-filter-split-queue-policies: CMD = run libavfilter/tests/splitqueue$(EXESUF)
+
+FATE_FILTER-$(call ALLYES, CROP_FILTER SCALE_FILTER HFLIP_FILTER PAD_FILTER VFLIP_FILTER SPLIT_FILTER SETSAR_FILTER) += fate-filter-reconfigure
+fate-filter-reconfigure: libavfilter/tests/reconfigure$(EXESUF)
+fate-filter-reconfigure: CMD = run libavfilter/tests/reconfigure$(EXESUF)
+
+# the pipelined chain must match the same chain run in a single graph
+FATE_FILTER_VSYNTH_PGMYUV-$(call ALLYES, PIPELINE_FILTER HFLIP_FILTER TRANSPOSE_FILTER VFLIP_FILTER DRAWGRID_FILTER) += fate-filter-pipeline fate-filter-pipeline-queue fate-filter-pipeline-chain
+fate-filter-pipeline: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf "pipeline=stages=hflip|transpose|vflip|drawgrid=w=16"
+fate-filter-pipeline-queue: CMD = framecrc -filter_threads 2 -c:v pgmyuv -i $(SRC) -vf "pipeline=stages=hflip|transpose|vflip|drawgrid=w=16:queue_size=1"
+fate-filter-pipeline-queue: REF = $(SRC_PATH)/tests/ref/fate/filter-pipeline
+fate-filter-pipeline-chain: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf "hflip,transpose,vflip,drawgrid=w=16"
+fate-filter-pipeline-chain: REF = $(SRC_PATH)/tests/ref/fate/filter-pipeline
+
+FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_SCALE_LADDER_FILTER) += fate-filter-scale-ladder fate-filter-scale-ladder-threads
+fate-filter-scale-ladder: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex "scale_ladder=sizes=176x144|88x72|48x32:flags=bicubic+accurate_rnd+bitexact[a][b][c]" -map "[a]" -map "[b]" -map "[c]" -frames:v 10
+fate-filter-scale-ladder-threads: CMD = framecrc -filter_complex_threads 3 -c:v pgmyuv -i $(SRC) -filter_complex "scale_ladder=sizes=176x144|88x72|48x32:flags=bicubic+accurate_rnd+bitexact[a][b][c]" -map "[a]" -map "[b]" -map "[c]" -frames:v 10
+fate-filter-scale-ladder-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-scale-ladder
+
+# the ladder must match the same sizes scaled one after another
+FATE_FILTER_VSYNTH_PGMYUV-$(call ALLYES, SCALE_LADDER_FILTER SCALE_FILTER SPLIT_FILTER) += fate-filter-scale-ladder-chain
+fate-filter-scale-ladder-chain: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_complex "scale=176x144:flags=bicubic+accurate_rnd+bitexact,split[a][a1]\;[a1]scale=88x72:flags=bicubic+accurate_rnd+bitexact,split[b][b1]\;[b1]scale=48x32:flags=bicubic+accurate_rnd+bitexact[c]" -map "[a]" -map "[b]" -map "[c]" -frames:v 10
+fate-filter-scale-ladder-chain: REF = $(SRC_PATH)/tests/ref/fate/filter-scale-ladder
+
+# sharing the common hflip of the two output streams must not change them
+FATE_FILTER_VSYNTH_PGMYUV-$(call ALLYES, SPLIT_FILTER HFLIP_FILTER VFLIP_FILTER) += fate-filter-share-prefix fate-filter-share-prefix-off
+fate-filter-share-prefix: CMD = framecrc -share_filter_prefix -c:v pgmyuv -i $(SRC) -map 0:v -filter:v:0 hflip,vflip -map 0:v -filter:v:1 hflip -frames:v 10
+fate-filter-share-prefix-off: CMD = framecrc -c:v pgmyuv -i $(SRC) -map 0:v -filter:v:0 hflip,vflip -map 0:v -filter:v:1 hflip -frames:v 10
+fate-filter-share-prefix-off: REF = $(SRC_PATH)/tests/ref/fate/filter-share-prefix
+
+FATE_FILTER_VSYNTH_PGMYUV-$(call ALLYES, SCALE_FILTER FORMAT_FILTER HFLIP_FILTER VFLIP_FILTER) += fate-filter-negotiation-cost
+fate-filter-negotiation-cost: CMD = framecrc -c:v pgmyuv -i $(SRC) -filter_negotiation cost -vf "scale=w=300:h=200,format=gbrp|yuv444p|rgb24,hflip,scale=w=200:h=100,format=rgb24|bgr24|yuv420p,vflip" -pix_fmt rgb24 -sws_flags +accurate_rnd+bitexact
+
 FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_FADE_FILTER) += fate-filter-fade
 fate-filter-fade: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf fade=in:5:15,fade=out:30:15
 
@@ -479,6 +541,16 @@ fate-filter-idet: CMD = framecrc -flags bitexact -idct simple -i $(SRC) -vf idet
 FATE_FILTER_VSYNTH_VIDEO_FILTER-$(CONFIG_PAD_FILTER) += fate-filter-pad
 fate-filter-pad: CMD = video_filter "pad=iw*1.5:ih*1.5:iw*0.3:ih*0.2"
 
+FATE_FILTER_VSYNTH_PGMYUV-$(CONFIG_PAD_FILTER) += fate-filter-pad-slice fate-filter-pad-slice-threads
+fate-filter-pad-slice: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf pad=iw+34:ih+27:18:11:blue
+fate-filter-pad-slice-threads: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf pad=iw+34:ih+27:18:11:blue -filter_threads 4
+fate-filter-pad-slice-threads: REF = $(SRC_PATH)/tests/ref/fate/filter-pad-slice
+
+FATE_FILTER_VSYNTH_PGMYUV-$(call ALLYES, PAD_FILTER HFLIP_FILTER) += fate-filter-pad-hflip fate-filter-pad-hflip-framepool
+fate-filter-pad-hflip: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf pad=iw+34:ih+27:18:11:blue,hflip
+fate-filter-pad-hflip-framepool: CMD = framecrc -c:v pgmyuv -i $(SRC) -vf pad=iw+34:ih+27:18:11:blue,hflip -filter_pool_size 1M
+fate-filter-pad-hflip-framepool: REF = $(SRC_PATH)/tests/ref/fate/filter-pad-hflip
+
 fate-filter-pp1: CMD = video_filter "pp=fq|4/be/hb/vb/tn/l5/al"
 fate-filter-pp2: CMD = video_filter "qp=2*(x+y),pp=be/h1/v1/lb"
 fate-filter-pp3: CMD = video_filter "qp=2*(x+y),pp=be/ha|128|7/va/li"
@@ -1098,4 +1098,14 @@ fate-swr-audioconvert: FUZZ = 0
 
 FATE_SWR += $(FATE_SWR_AUDIOCONVERT-yes)
 FATE_FFMPEG += $(FATE_SWR)
-fate-swr: $(FATE_SWR)
+
+FATE_SWR_STREAMING-$(CONFIG_SWRESAMPLE) += fate-swr-streaming
+fate-swr-streaming: libswresample/tests/streaming$(EXESUF)
+fate-swr-streaming: CMD = run libswresample/tests/streaming$(EXESUF)
+
+FATE_SWR_STREAMING-$(HAVE_THREADS) += fate-swr-filterbank
+fate-swr-filterbank: libswresample/tests/filterbank$(EXESUF)
+fate-swr-filterbank: CMD = run libswresample/tests/filterbank$(EXESUF)
+
+FATE-$(CONFIG_SWRESAMPLE) += $(FATE_SWR_STREAMING-yes)
+fate-swr: $(FATE_SWR) $(FATE_SWR_STREAMING-yes)
@@ -6,6 +6,14 @@ FATE_LIBSWSCALE += fate-sws-floatimg-cmp
 fate-sws-floatimg-cmp: libswscale/tests/floatimg_cmp$(EXESUF)
 fate-sws-floatimg-cmp: CMD = run libswscale/tests/floatimg_cmp$(EXESUF)
 
+FATE_LIBSWSCALE += fate-sws-normalize
+fate-sws-normalize: libswscale/tests/normalize$(EXESUF)
+fate-sws-normalize: CMD = run libswscale/tests/normalize$(EXESUF)
+
+FATE_LIBSWSCALE += fate-sws-roi
+fate-sws-roi: libswscale/tests/roi$(EXESUF)
+fate-sws-roi: CMD = run libswscale/tests/roi$(EXESUF)
+
 SWS_SLICE_TEST-$(call DEMDEC, MATROSKA, VP9) += fate-sws-slice-yuv422-12bit-rgb48
 fate-sws-slice-yuv422-12bit-rgb48: CMD = run tools/scale_slice_test$(EXESUF) $(TARGET_SAMPLES)/vp9-test-vectors/vp93-2-20-12bit-yuv422.webm 150 100 rgb48
 
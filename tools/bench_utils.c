@@ -0,0 +1,38 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* shared code for the benchmark tools */
+
+#include <string.h>
+
+#include "bench_utils.h"
+
+#include "libavutil/common.h"
+#include "libavutil/frame.h"
+#include "libavutil/lfg.h"
+
+void bench_fill_frame(AVFrame *frame, AVLFG *lfg)
+{
+    for (int p = 0; p < AV_NUM_DATA_POINTERS && frame->buf[p]; p++) {
+        uint8_t *data = frame->buf[p]->data;
+        for (size_t j = 0; j < frame->buf[p]->size; j += 4) {
+            unsigned r = av_lfg_get(lfg);
+            memcpy(data + j, &r, FFMIN(4, frame->buf[p]->size - j));
+        }
+    }
+}
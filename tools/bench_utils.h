@@ -0,0 +1,33 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/* shared code for the benchmark tools */
+
+#ifndef TOOLS_BENCH_UTILS_H
+#define TOOLS_BENCH_UTILS_H
+
+#include "libavutil/frame.h"
+#include "libavutil/lfg.h"
+
+/**
+ * Fill all the buffers of a frame, padding included, with random bytes
+ * from lfg.
+ */
+void bench_fill_frame(AVFrame *frame, AVLFG *lfg);
+
+#endif /* TOOLS_BENCH_UTILS_H */
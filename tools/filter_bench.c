@@ -0,0 +1,379 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Benchmark a filtergraph in isolation: the graph is fed from frames
+ * generated in memory once, so the figures only reflect the filters.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "bench_utils.h"
+
+#include "libavutil/common.h"
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+/* number of distinct source frames cycled through */
+#define NB_SOURCE_FRAMES 4
+
+typedef struct BenchContext {
+    int width, height;
+    enum AVPixelFormat pix_fmt;
+    AVRational frame_rate;
+    int nb_frames;
+    int nb_threads;
+    int64_t pool_size;
+
+    AVFilterGraph    *graph;
+    AVFilterContext  *src;
+    AVFilterContext **sinks;
+    int            nb_sinks;
+
+    AVFrame *source[NB_SOURCE_FRAMES];
+    AVFrame *out;
+    int64_t  nb_out;
+
+    /* time spent in the graph, excluding the copies of the source frames */
+    int64_t  elapsed;
+} BenchContext;
+
+static void usage(const char *name)
+{
+    fprintf(stderr,
+            "Usage: %s [options] <filtergraph>\n"
+            "Options:\n"
+            "  -s <size>       input frame size (default 1920x1080)\n"
+            "  -pix_fmt <fmt>  input pixel format (default yuv420p)\n"
+            "  -r <rate>       input frame rate (default 25)\n"
+            "  -n <frames>     number of frames to filter (default 100)\n"
+            "  -threads <n>    number of filtering threads, 0 for auto (default 0)\n"
+            "  -pool <bytes>   size of the graph shared frame pool, 0 to disable (default 0)\n"
+            "The graph must have one unconnected video input and may have several\n"
+            "unconnected outputs, e.g. \"scale=1280:720,split[a][b]\".\n",
+            name);
+}
+
+static int alloc_source_frames(BenchContext *bc)
+{
+    AVLFG lfg;
+    int ret;
+
+    av_lfg_init(&lfg, 0xdeadbeef);
+
+    for (int i = 0; i < NB_SOURCE_FRAMES; i++) {
+        AVFrame *frame = av_frame_alloc();
+        if (!frame)
+            return AVERROR(ENOMEM);
+        bc->source[i] = frame;
+
+        frame->width  = bc->width;
+        frame->height = bc->height;
+        frame->format = bc->pix_fmt;
+
+        ret = av_frame_get_buffer(frame, 0);
+        if (ret < 0)
+            return ret;
+
+        /* random content, so that no filter can take shortcuts on
+         * uniform areas */
+        bench_fill_frame(frame, &lfg);
+    }
+
+    return 0;
+}
+
+static int init_graph(BenchContext *bc, const char *graph_desc)
+{
+    AVFilterInOut *inputs = NULL, *outputs = NULL, *cur;
+    char args[256];
+    int ret;
+
+    bc->graph = avfilter_graph_alloc();
+    if (!bc->graph)
+        return AVERROR(ENOMEM);
+
+    bc->graph->nb_threads = bc->nb_threads;
+    if ((ret = av_opt_set_int(bc->graph, "filter_timing", 1, 0)) < 0 ||
+        (ret = av_opt_set_int(bc->graph, "frame_pool_size", bc->pool_size, 0)) < 0)
+        return ret;
+
+    ret = avfilter_graph_parse2(bc->graph, graph_desc, &inputs, &outputs);
+    if (ret < 0) {
+        fprintf(stderr, "Error parsing the filtergraph: %s\n", av_err2str(ret));
+        return ret;
+    }
+
+    if (!inputs || inputs->next || !outputs) {
+        fprintf(stderr, "The filtergraph must have exactly one unconnected "
+                "input and at least one unconnected output\n");
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+
+    snprintf(args, sizeof(args),
+             "video_size=%dx%d:pix_fmt=%d:time_base=%d/%d:pixel_aspect=1/1:frame_rate=%d/%d",
+             bc->width, bc->height, bc->pix_fmt,
+             bc->frame_rate.den, bc->frame_rate.num,
+             bc->frame_rate.num, bc->frame_rate.den);
+    ret = avfilter_graph_create_filter(&bc->src, avfilter_get_by_name("buffer"),
+                                       "bench_src", args, NULL, bc->graph);
+    if (ret < 0)
+        goto end;
+    ret = avfilter_link(bc->src, 0, inputs->filter_ctx, inputs->pad_idx);
+    if (ret < 0)
+        goto end;
+
+    for (cur = outputs; cur; cur = cur->next) {
+        AVFilterContext *sink;
+        char name[32];
+
+        if (avfilter_pad_get_type(cur->filter_ctx->output_pads, cur->pad_idx) !=
+            AVMEDIA_TYPE_VIDEO) {
+            fprintf(stderr, "Only video outputs are supported\n");
+            ret = AVERROR(EINVAL);
+            goto end;
+        }
+
+        snprintf(name, sizeof(name), "bench_sink%d", bc->nb_sinks);
+        ret = avfilter_graph_create_filter(&sink, avfilter_get_by_name("buffersink"),
+                                           name, NULL, NULL, bc->graph);
+        if (ret < 0)
+            goto end;
+        ret = avfilter_link(cur->filter_ctx, cur->pad_idx, sink, 0);
+        if (ret < 0)
+            goto end;
+
+        ret = av_dynarray_add_nofree(&bc->sinks, &bc->nb_sinks, sink);
+        if (ret < 0)
+            goto end;
+    }
+
+    ret = avfilter_graph_config(bc->graph, NULL);
+    if (ret < 0)
+        fprintf(stderr, "Error configuring the filtergraph: %s\n", av_err2str(ret));
+
+end:
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    return ret;
+}
+
+static int drain_sinks(BenchContext *bc)
+{
+    for (int i = 0; i < bc->nb_sinks; i++) {
+        int ret;
+
+        while ((ret = av_buffersink_get_frame(bc->sinks[i], bc->out)) >= 0) {
+            av_frame_unref(bc->out);
+            bc->nb_out++;
+        }
+        if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+            return ret;
+    }
+    return 0;
+}
+
+/**
+ * Make a writable copy of a source frame for the graph to own, as a decoder
+ * would hand over, so that filters working in place do not have to copy it.
+ */
+static AVFrame *copy_source_frame(const AVFrame *src)
+{
+    AVFrame *frame = av_frame_alloc();
+
+    if (!frame)
+        return NULL;
+
+    frame->width  = src->width;
+    frame->height = src->height;
+    frame->format = src->format;
+    if (av_frame_get_buffer(frame, 0) < 0 ||
+        av_frame_copy(frame, src) < 0)
+        av_frame_free(&frame);
+
+    return frame;
+}
+
+static int run(BenchContext *bc)
+{
+    int64_t start;
+    int ret;
+
+    for (int i = 0; i < bc->nb_frames; i++) {
+        AVFrame *frame = copy_source_frame(bc->source[i % NB_SOURCE_FRAMES]);
+
+        if (!frame)
+            return AVERROR(ENOMEM);
+        frame->pts = i;
+
+        start = av_gettime_relative();
+        ret = av_buffersrc_add_frame(bc->src, frame);
+        if (ret >= 0)
+            ret = drain_sinks(bc);
+        bc->elapsed += av_gettime_relative() - start;
+
+        av_frame_free(&frame);
+        if (ret < 0)
+            return ret;
+    }
+
+    start = av_gettime_relative();
+    ret = av_buffersrc_add_frame(bc->src, NULL);
+    if (ret >= 0)
+        ret = drain_sinks(bc);
+    bc->elapsed += av_gettime_relative() - start;
+
+    return ret;
+}
+
+static void report(BenchContext *bc)
+{
+    int64_t total = 0, allocs, hits;
+
+    for (unsigned i = 0; i < bc->graph->nb_filters; i++) {
+        int64_t t;
+        av_opt_get_int(bc->graph->filters[i], "activate_time", 0, &t);
+        total += t;
+    }
+
+    printf("%-24s %-16s %12s %12s %8s\n",
+           "instance", "filter", "activations", "time (us)", "time %");
+    for (unsigned i = 0; i < bc->graph->nb_filters; i++) {
+        AVFilterContext *f = bc->graph->filters[i];
+        int64_t nb, t;
+
+        av_opt_get_int(f, "activations",   0, &nb);
+        av_opt_get_int(f, "activate_time", 0, &t);
+        printf("%-24s %-16s %12"PRId64" %12"PRId64" %7.2f%%\n",
+               f->name, f->filter->name, nb, t, total ? 100.0 * t / total : 0.0);
+    }
+
+    printf("\n%d input frames, %"PRId64" output frames in %.3f s: %.2f fps\n",
+           bc->nb_frames, bc->nb_out, bc->elapsed / 1e6,
+           bc->elapsed ? bc->nb_frames * 1e6 / bc->elapsed : 0.0);
+
+    av_opt_get_int(bc->graph, "frame_allocations", 0, &allocs);
+    printf("frame buffers: %"PRId64" allocated", allocs);
+    if (bc->pool_size) {
+        av_opt_get_int(bc->graph, "frame_pool_hits", 0, &hits);
+        printf(", %"PRId64" reused from the shared pool", hits);
+    }
+    printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+    BenchContext bc = {
+        .width      = 1920,
+        .height     = 1080,
+        .pix_fmt    = AV_PIX_FMT_YUV420P,
+        .frame_rate = { 25, 1 },
+        .nb_frames  = 100,
+    };
+    const char *graph_desc = NULL;
+    int ret;
+
+    for (int i = 1; i < argc; i++) {
+        const char *opt = argv[i], *arg = i + 1 < argc ? argv[i + 1] : NULL;
+
+        if (opt[0] != '-') {
+            graph_desc = opt;
+            continue;
+        }
+        if (!arg) {
+            usage(argv[0]);
+            return 1;
+        }
+        i++;
+
+        if (!strcmp(opt, "-s")) {
+            ret = av_parse_video_size(&bc.width, &bc.height, arg);
+        } else if (!strcmp(opt, "-pix_fmt")) {
+            bc.pix_fmt = av_get_pix_fmt(arg);
+            ret = bc.pix_fmt == AV_PIX_FMT_NONE ? AVERROR(EINVAL) : 0;
+        } else if (!strcmp(opt, "-r")) {
+            ret = av_parse_video_rate(&bc.frame_rate, arg);
+        } else if (!strcmp(opt, "-n")) {
+            bc.nb_frames = strtol(arg, NULL, 0);
+            ret = bc.nb_frames > 0 ? 0 : AVERROR(EINVAL);
+        } else if (!strcmp(opt, "-threads")) {
+            bc.nb_threads = strtol(arg, NULL, 0);
+            ret = bc.nb_threads >= 0 ? 0 : AVERROR(EINVAL);
+        } else if (!strcmp(opt, "-pool")) {
+            bc.pool_size = strtoll(arg, NULL, 0);
+            ret = bc.pool_size >= 0 ? 0 : AVERROR(EINVAL);
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+
+        if (ret < 0) {
+            fprintf(stderr, "Invalid value '%s' for %s\n", arg, opt);
+            return 1;
+        }
+    }
+
+    if (!graph_desc) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    bc.out = av_frame_alloc();
+    if (!bc.out) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+
+    ret = alloc_source_frames(&bc);
+    if (ret < 0)
+        goto end;
+
+    ret = init_graph(&bc, graph_desc);
+    if (ret < 0)
+        goto end;
+
+    ret = run(&bc);
+    if (ret < 0) {
+        fprintf(stderr, "Error while filtering: %s\n", av_err2str(ret));
+        goto end;
+    }
+
+    report(&bc);
+
+end:
+    avfilter_graph_free(&bc.graph);
+    av_freep(&bc.sinks);
+    for (int i = 0; i < NB_SOURCE_FRAMES; i++)
+        av_frame_free(&bc.source[i]);
+    av_frame_free(&bc.out);
+    return ret < 0;
+}
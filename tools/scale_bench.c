@@ -0,0 +1,148 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Benchmark a single swscale conversion on generated frames, e.g. the
+ * NV12/P010 to YUV420P/YUV420P10 conversions following hardware decoding.
+ */
+
+#include <inttypes.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "bench_utils.h"
+
+#include "libavutil/error.h"
+#include "libavutil/frame.h"
+#include "libavutil/lfg.h"
+#include "libavutil/opt.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+
+#include "libswscale/swscale.h"
+
+static int alloc_frame(AVFrame **pframe, int width, int height,
+                       enum AVPixelFormat pix_fmt)
+{
+    AVFrame *frame = av_frame_alloc();
+    if (!frame)
+        return AVERROR(ENOMEM);
+    *pframe = frame;
+
+    frame->width  = width;
+    frame->height = height;
+    frame->format = pix_fmt;
+
+    return av_frame_get_buffer(frame, 0);
+}
+
+int main(int argc, char **argv)
+{
+    int src_w, src_h, dst_w, dst_h, nb_frames = 100;
+    enum AVPixelFormat src_fmt, dst_fmt;
+    const char *flags = "bicubic";
+    struct SwsContext *sws = NULL;
+    AVFrame *src = NULL, *dst = NULL;
+    AVLFG lfg;
+    int64_t start, elapsed;
+    int ret;
+
+    if (argc <= 4) {
+        fprintf(stderr,
+                "Usage: %s <src size> <src pixfmt> <dst size> <dst pixfmt> "
+                "[<frames>] [<sws flags>]\n", argv[0]);
+        return 1;
+    }
+
+    if (av_parse_video_size(&src_w, &src_h, argv[1]) < 0 ||
+        av_parse_video_size(&dst_w, &dst_h, argv[3]) < 0) {
+        fprintf(stderr, "Invalid frame size\n");
+        return 1;
+    }
+    src_fmt = av_get_pix_fmt(argv[2]);
+    dst_fmt = av_get_pix_fmt(argv[4]);
+    if (src_fmt == AV_PIX_FMT_NONE || dst_fmt == AV_PIX_FMT_NONE) {
+        fprintf(stderr, "Invalid pixel format\n");
+        return 1;
+    }
+    if (argc >= 6) {
+        nb_frames = strtol(argv[5], NULL, 0);
+        if (nb_frames <= 0) {
+            fprintf(stderr, "Invalid number of frames '%s'\n", argv[5]);
+            return 1;
+        }
+    }
+    if (argc >= 7)
+        flags = argv[6];
+
+    if ((ret = alloc_frame(&src, src_w, src_h, src_fmt)) < 0 ||
+        (ret = alloc_frame(&dst, dst_w, dst_h, dst_fmt)) < 0)
+        goto end;
+
+    /* random content; the scalers have no data-dependent shortcuts, but
+     * this keeps out-of-range values in the high bit depth formats */
+    av_lfg_init(&lfg, 0xdeadbeef);
+    bench_fill_frame(src, &lfg);
+
+    sws = sws_alloc_context();
+    if (!sws) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    av_opt_set_int(sws, "srcw",       src_w,   0);
+    av_opt_set_int(sws, "srch",       src_h,   0);
+    av_opt_set_int(sws, "src_format", src_fmt, 0);
+    av_opt_set_int(sws, "dstw",       dst_w,   0);
+    av_opt_set_int(sws, "dsth",       dst_h,   0);
+    av_opt_set_int(sws, "dst_format", dst_fmt, 0);
+    ret = av_opt_set(sws, "sws_flags", flags, 0);
+    if (ret < 0) {
+        fprintf(stderr, "Invalid flags '%s'\n", flags);
+        goto end;
+    }
+    ret = sws_init_context(sws, NULL, NULL);
+    if (ret < 0) {
+        fprintf(stderr, "Error initializing the scaler: %s\n", av_err2str(ret));
+        goto end;
+    }
+
+    start = av_gettime_relative();
+    for (int i = 0; i < nb_frames; i++) {
+        ret = sws_scale(sws, (const uint8_t * const *)src->data, src->linesize,
+                        0, src_h, dst->data, dst->linesize);
+        if (ret < 0) {
+            fprintf(stderr, "Error scaling: %s\n", av_err2str(ret));
+            goto end;
+        }
+    }
+    elapsed = av_gettime_relative() - start;
+
+    printf("%s %dx%d -> %s %dx%d (%s): %d frames in %.3f s, %.1f us/frame, %.2f fps\n",
+           av_get_pix_fmt_name(src_fmt), src_w, src_h,
+           av_get_pix_fmt_name(dst_fmt), dst_w, dst_h, flags,
+           nb_frames, elapsed / 1e6, (double)elapsed / nb_frames,
+           elapsed ? nb_frames * 1e6 / elapsed : 0.0);
+    ret = 0;
+
+end:
+    sws_freeContext(sws);
+    av_frame_free(&src);
+    av_frame_free(&dst);
+    return ret < 0;
+}